@@ -0,0 +1,30 @@
+local logFile = "data/logs/task_statistics.log"
+local popupSites = 10
+
+function onSay(player, words, param)
+	logCommand(player, words, param)
+
+	local action = param:lower():trim()
+	if action == "on" or action == "off" then
+		Game.setTaskStatisticsEnabled(action == "on")
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Task statistics turned " .. action .. ".")
+		return false
+	elseif action == "reset" then
+		Game.resetTaskStatistics()
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Task statistics reset.")
+		return false
+	elseif action ~= "" then
+		player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Usage: " .. words .. " [on|off|reset]")
+		return false
+	end
+
+	local file = io.open(logFile, "a")
+	if file then
+		file:write(("[%s]\n%s\n"):format(os.date("%d/%m/%Y %H:%M:%S"), Game.getTaskStatistics()))
+		file:close()
+	end
+
+	player:popupFYI(Game.getTaskStatistics(popupSites))
+	player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "Full task statistics written to " .. logFile .. ".")
+	return false
+end
@@ -23,11 +23,10 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream)
 			}
 
 			if (guid != 0) {
-				auto name = IOLoginData::getNameByGuid(guid);
-				if (!name.empty()) {
-					setSpecialDescription(fmt::format("{} is sleeping there.", name));
-					g_game.setBedSleeper(this, guid);
+				if (Item::deferRegistration) {
 					sleeperGUID = guid;
+				} else {
+					setSleeper(guid);
 				}
 			}
 			return ATTR_READ_CONTINUE;
@@ -49,6 +48,25 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream)
 	return Item::readAttr(attr, propStream);
 }
 
+void BedItem::registerSleeper()
+{
+	uint32_t guid = sleeperGUID;
+	sleeperGUID = 0;
+	if (guid != 0) {
+		setSleeper(guid);
+	}
+}
+
+void BedItem::setSleeper(uint32_t guid)
+{
+	auto name = IOLoginData::getNameByGuid(guid);
+	if (!name.empty()) {
+		setSpecialDescription(fmt::format("{} is sleeping there.", name));
+		g_game.setBedSleeper(this, guid);
+		sleeperGUID = guid;
+	}
+}
+
 void BedItem::serializeAttr(PropWriteStream& propWriteStream) const
 {
 	if (sleeperGUID != 0) {
@@ -23,6 +23,8 @@ public:
 	bool canRemove() const override { return house == nullptr; }
 
 	uint32_t getSleeper() const { return sleeperGUID; }
+	// Looks up the sleeper read while Item::deferRegistration was set.
+	void registerSleeper();
 
 	House* getHouse() const { return house; }
 	void setHouse(House* h) { house = h; }
@@ -40,6 +42,7 @@ private:
 	void regeneratePlayer(Player* player) const;
 	void internalSetSleeper(const Player* player);
 	void internalRemoveSleeper();
+	void setSleeper(uint32_t guid);
 
 	House* house = nullptr;
 	uint64_t sleepStart;
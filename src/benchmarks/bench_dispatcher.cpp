@@ -0,0 +1,132 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../tasks.h"
+#include "benchmark.h"
+
+#include <future>
+
+namespace {
+
+// Dispatcher before the lock-free queue, a mutex protected vector of heap allocated std::function tasks, kept here as
+// the baseline.
+class LegacyDispatcher : public ThreadHolder<LegacyDispatcher>
+{
+public:
+	struct LegacyTask
+	{
+		explicit LegacyTask(std::function<void(void)>&& f) : func(std::move(f)) {}
+		std::function<void(void)> func;
+	};
+
+	void addTask(std::function<void(void)>&& f)
+	{
+		LegacyTask* task = new LegacyTask(std::move(f));
+		bool do_signal = false;
+
+		taskLock.lock();
+		if (getState() == THREAD_STATE_RUNNING) {
+			do_signal = taskList.empty();
+			taskList.push_back(task);
+		} else {
+			delete task;
+		}
+		taskLock.unlock();
+
+		if (do_signal) {
+			taskSignal.notify_one();
+		}
+	}
+
+	void shutdown()
+	{
+		std::lock_guard<std::mutex> lockClass(taskLock);
+		taskList.push_back(new LegacyTask([this]() { setState(THREAD_STATE_TERMINATED); }));
+		taskSignal.notify_one();
+	}
+
+	void threadMain()
+	{
+		std::vector<LegacyTask*> tmpTaskList;
+		std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
+
+		while (getState() != THREAD_STATE_TERMINATED) {
+			taskLockUnique.lock();
+			if (taskList.empty()) {
+				taskSignal.wait(taskLockUnique);
+			}
+			tmpTaskList.swap(taskList);
+			taskLockUnique.unlock();
+
+			for (LegacyTask* task : tmpTaskList) {
+				task->func();
+				delete task;
+			}
+			tmpTaskList.clear();
+		}
+	}
+
+private:
+	std::mutex taskLock;
+	std::condition_variable taskSignal;
+	std::vector<LegacyTask*> taskList;
+};
+
+// Posts tasksPerProducer tasks from each producer thread and returns once the dispatcher ran all of them.
+template <class DispatcherType>
+double runProducers(std::string_view name, uint32_t producerCount, uint32_t tasksPerProducer)
+{
+	DispatcherType dispatcher;
+	dispatcher.start();
+
+	struct Progress
+	{
+		uint64_t total;
+		uint64_t sum = 0;
+		uint64_t ran = 0;
+		std::promise<void> allRan;
+	} progress{static_cast<uint64_t>(producerCount) * tasksPerProducer};
+
+	double perSecond = benchmark::run(fmt::format("{}, {} producers", name, producerCount), progress.total, [&]() {
+		std::vector<std::thread> producers;
+		for (uint32_t producer = 0; producer < producerCount; ++producer) {
+			producers.emplace_back([&, producer]() {
+				for (uint32_t i = 0; i < tasksPerProducer; ++i) {
+					// about the size of a packet handler capture: a player id and a few arguments
+					dispatcher.addTask([progress = &progress, a = uint64_t{i}, b = uint64_t{producer}]() {
+						progress->sum += a + b;
+						if (++progress->ran == progress->total) {
+							progress->allRan.set_value();
+						}
+					});
+				}
+			});
+		}
+
+		for (std::thread& thread : producers) {
+			thread.join();
+		}
+		progress.allRan.get_future().wait();
+	});
+	benchmark::doNotOptimize(progress.sum);
+
+	dispatcher.shutdown();
+	dispatcher.join();
+	return perSecond;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	uint32_t tasksPerProducer = argc > 1 ? std::stoul(argv[1]) : 200'000;
+
+	for (uint32_t producers : {1, 2, 4, 8}) {
+		double legacy = runProducers<LegacyDispatcher>("mutex + std::function", producers, tasksPerProducer);
+		double lockfree = runProducers<Dispatcher>("lock-free queue + pooled tasks", producers, tasksPerProducer);
+		fmt::print("{} producers: speedup {:.2f}x\n\n", producers, lockfree / legacy);
+	}
+	return 0;
+}
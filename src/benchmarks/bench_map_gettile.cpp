@@ -0,0 +1,172 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../map.h"
+#include "../tile.h"
+#include "benchmark.h"
+
+namespace {
+
+// The quadtree Map used before the sector storage, kept here as the baseline.
+class LegacyQuadTree
+{
+	struct Node
+	{
+		~Node()
+		{
+			for (auto* ptr : child) {
+				delete ptr;
+			}
+			for (auto* ptr : floors) {
+				delete[] ptr;
+			}
+		}
+
+		bool leaf = false;
+		Node* child[4] = {};
+		Tile** floors[MAP_MAX_LAYERS] = {};
+	};
+
+	static constexpr uint32_t LEAF_BITS = 3;
+	static constexpr uint32_t LEAF_SIZE = 1 << LEAF_BITS;
+	static constexpr uint32_t LEAF_MASK = LEAF_SIZE - 1;
+
+public:
+	void setTile(uint16_t x, uint16_t y, uint8_t z, Tile* tile)
+	{
+		Node* node = &root;
+		uint32_t cx = x, cy = y;
+		for (uint32_t level = 15; !node->leaf; --level) {
+			Node*& next = node->child[((cx & 0x8000) >> 15) | ((cy & 0x8000) >> 14)];
+			if (!next) {
+				next = new Node();
+				next->leaf = level == LEAF_BITS;
+			}
+			node = next;
+			cx <<= 1;
+			cy <<= 1;
+		}
+
+		if (!node->floors[z]) {
+			node->floors[z] = new Tile*[LEAF_SIZE * LEAF_SIZE]();
+		}
+		node->floors[z][(x & LEAF_MASK) * LEAF_SIZE + (y & LEAF_MASK)] = tile;
+	}
+
+	Tile* getTile(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		if (z >= MAP_MAX_LAYERS) {
+			return nullptr;
+		}
+
+		const Node* node = &root;
+		uint32_t cx = x, cy = y;
+		do {
+			node = node->child[((cx & 0x8000) >> 15) | ((cy & 0x8000) >> 14)];
+			if (!node) {
+				return nullptr;
+			}
+			cx <<= 1;
+			cy <<= 1;
+		} while (!node->leaf);
+
+		Tile* const* floor = node->floors[z];
+		if (!floor) {
+			return nullptr;
+		}
+		return floor[(x & LEAF_MASK) * LEAF_SIZE + (y & LEAF_MASK)];
+	}
+
+private:
+	Node root;
+};
+
+constexpr uint16_t MAP_ORIGIN_X = 31744;
+constexpr uint16_t MAP_ORIGIN_Y = 31744;
+constexpr uint16_t MAP_WIDTH = 1024;
+constexpr uint16_t MAP_HEIGHT = 1024;
+
+constexpr size_t RANDOM_LOOKUPS = 10'000'000;
+constexpr size_t VIEWPORT_SCANS = 50'000;
+
+template <class Storage>
+void randomLookups(const Storage& storage, const std::vector<Position>& positions)
+{
+	uintptr_t found = 0;
+	for (const Position& pos : positions) {
+		found += reinterpret_cast<uintptr_t>(storage.getTile(pos.x, pos.y, pos.z));
+	}
+	benchmark::doNotOptimize(found);
+}
+
+// Scans the full client viewport around each center, like GetMapDescription or a spectator sweep does.
+template <class Storage>
+void viewportScans(const Storage& storage, const std::vector<Position>& centers)
+{
+	uintptr_t found = 0;
+	for (const Position& center : centers) {
+		for (int32_t x = center.x - Map::maxClientViewportX; x <= center.x + Map::maxClientViewportX + 1; ++x) {
+			for (int32_t y = center.y - Map::maxClientViewportY; y <= center.y + Map::maxClientViewportY + 1; ++y) {
+				found += reinterpret_cast<uintptr_t>(storage.getTile(x, y, center.z));
+			}
+		}
+	}
+	benchmark::doNotOptimize(found);
+}
+
+} // namespace
+
+int main()
+{
+	Map map;
+	LegacyQuadTree quadTree;
+
+	// a surface floor fully covered with tiles and a sparse cave floor below it
+	for (uint16_t x = MAP_ORIGIN_X; x < MAP_ORIGIN_X + MAP_WIDTH; ++x) {
+		for (uint16_t y = MAP_ORIGIN_Y; y < MAP_ORIGIN_Y + MAP_HEIGHT; ++y) {
+			for (uint8_t z : {7, 8}) {
+				if (z == 8 && (x ^ y) % 3 != 0) {
+					continue;
+				}
+
+				Tile* tile = new StaticTile(x, y, z);
+				map.setTile(x, y, z, tile);
+				quadTree.setTile(x, y, z, tile);
+			}
+		}
+	}
+
+	std::mt19937 rng(0xdeadbeef);
+	std::uniform_int_distribution<uint16_t> randomX(MAP_ORIGIN_X - 64, MAP_ORIGIN_X + MAP_WIDTH + 64);
+	std::uniform_int_distribution<uint16_t> randomY(MAP_ORIGIN_Y - 64, MAP_ORIGIN_Y + MAP_HEIGHT + 64);
+	std::uniform_int_distribution<uint16_t> randomZ(6, 8);
+
+	std::vector<Position> positions(RANDOM_LOOKUPS);
+	for (Position& pos : positions) {
+		pos = Position(randomX(rng), randomY(rng), randomZ(rng));
+	}
+
+	std::vector<Position> centers(VIEWPORT_SCANS);
+	for (Position& pos : centers) {
+		pos = Position(randomX(rng), randomY(rng), 7);
+	}
+
+	const uint64_t viewportLookups =
+	    VIEWPORT_SCANS * (Map::maxClientViewportX * 2 + 2) * (Map::maxClientViewportY * 2 + 2);
+
+	double legacyRandom = benchmark::run("quadtree: random getTile", RANDOM_LOOKUPS,
+	                                     [&]() { randomLookups(quadTree, positions); });
+	double sectorRandom =
+	    benchmark::run("sectors: random getTile", RANDOM_LOOKUPS, [&]() { randomLookups(map, positions); });
+
+	double legacyLocal = benchmark::run("quadtree: viewport getTile", viewportLookups,
+	                                    [&]() { viewportScans(quadTree, centers); });
+	double sectorLocal =
+	    benchmark::run("sectors: viewport getTile", viewportLookups, [&]() { viewportScans(map, centers); });
+
+	fmt::print("random speedup: {:.2f}x, viewport speedup: {:.2f}x\n", sectorRandom / legacyRandom,
+	           sectorLocal / legacyLocal);
+	return 0;
+}
@@ -0,0 +1,382 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../game.h"
+#include "../iomap.h"
+#include "benchmark.h"
+
+extern Game g_game;
+
+namespace {
+
+class PathfindingCreature final : public Creature
+{
+public:
+	const std::string& getName() const override { return name; }
+	const std::string& getNameDescription() const override { return name; }
+	CreatureType_t getType() const override { return CREATURETYPE_MONSTER; }
+	std::string getDescription(int32_t) const override { return name; }
+
+	void setID() override {}
+	void removeList() override {}
+	void addList() override {}
+
+private:
+	std::string name = "pathfinder";
+};
+
+// AStarNodes before the binary heap and open addressing table, kept here as the baseline.
+class LegacyAStarNodes
+{
+public:
+	LegacyAStarNodes(uint32_t x, uint32_t y) : nodes(), openNodes()
+	{
+		openNodes[0] = true;
+		nodes[0].parent = nullptr;
+		nodes[0].x = static_cast<uint16_t>(x);
+		nodes[0].y = static_cast<uint16_t>(y);
+		nodes[0].f = 0;
+		nodeTable[(x << 16) | y] = nodes;
+	}
+
+	AStarNode* createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f)
+	{
+		if (curNode >= MAX_NODES) {
+			return nullptr;
+		}
+
+		size_t retNode = curNode++;
+		openNodes[retNode] = true;
+
+		AStarNode* node = nodes + retNode;
+		nodeTable[(x << 16) | y] = node;
+		node->parent = parent;
+		node->x = static_cast<uint16_t>(x);
+		node->y = static_cast<uint16_t>(y);
+		node->f = f;
+		return node;
+	}
+
+	AStarNode* getBestNode()
+	{
+		int32_t best_node_f = std::numeric_limits<int32_t>::max();
+		int32_t best_node = -1;
+		for (size_t i = 0; i < curNode; i++) {
+			if (openNodes[i] && nodes[i].f < best_node_f) {
+				best_node_f = nodes[i].f;
+				best_node = i;
+			}
+		}
+		return best_node >= 0 ? nodes + best_node : nullptr;
+	}
+
+	void closeNode(AStarNode* node)
+	{
+		openNodes[node - nodes] = false;
+		++closedNodes;
+	}
+
+	void openNode(AStarNode* node)
+	{
+		if (!openNodes[node - nodes]) {
+			openNodes[node - nodes] = true;
+			--closedNodes;
+		}
+	}
+
+	int_fast32_t getClosedNodes() const { return closedNodes; }
+
+	AStarNode* getNodeByPosition(uint32_t x, uint32_t y)
+	{
+		auto it = nodeTable.find((x << 16) | y);
+		return it != nodeTable.end() ? it->second : nullptr;
+	}
+
+private:
+	AStarNode nodes[MAX_NODES];
+	bool openNodes[MAX_NODES];
+	std::unordered_map<uint32_t, AStarNode*> nodeTable;
+	size_t curNode = 1;
+	int_fast32_t closedNodes = 0;
+};
+
+// Map::getPathMatching as it was before, running on LegacyAStarNodes.
+bool legacyGetPathMatching(const Map& map, const Creature& creature, std::vector<Direction>& dirList,
+                           const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
+{
+	Position pos = creature.getPosition();
+	Position endPos;
+
+	LegacyAStarNodes nodes(pos.x, pos.y);
+
+	int32_t bestMatch = 0;
+
+	static int_fast32_t dirNeighbors[8][5][2] = {
+	    {{-1, 0}, {0, 1}, {1, 0}, {1, 1}, {-1, 1}},    {{-1, 0}, {0, 1}, {0, -1}, {-1, -1}, {-1, 1}},
+	    {{-1, 0}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}}, {{0, 1}, {1, 0}, {0, -1}, {1, -1}, {1, 1}},
+	    {{1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}},  {{-1, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 1}},
+	    {{0, 1}, {1, 0}, {1, -1}, {1, 1}, {-1, 1}},    {{-1, 0}, {0, 1}, {-1, -1}, {1, 1}, {-1, 1}}};
+	static int_fast32_t allNeighbors[8][2] = {{-1, 0}, {0, 1}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+	const Position startPos = pos;
+
+	AStarNode* found = nullptr;
+	while (fpp.maxSearchDist != 0 || nodes.getClosedNodes() < 100) {
+		AStarNode* n = nodes.getBestNode();
+		if (!n) {
+			if (found) {
+				break;
+			}
+			return false;
+		}
+
+		const int_fast32_t x = n->x;
+		const int_fast32_t y = n->y;
+		pos.x = static_cast<uint16_t>(x);
+		pos.y = static_cast<uint16_t>(y);
+		if (pathCondition(startPos, pos, fpp, bestMatch)) {
+			found = n;
+			endPos = pos;
+			if (bestMatch == 0) {
+				break;
+			}
+		}
+
+		uint_fast32_t dirCount;
+		int_fast32_t* neighbors;
+		if (n->parent) {
+			const int_fast32_t offset_x = n->parent->x - x;
+			const int_fast32_t offset_y = n->parent->y - y;
+			if (offset_y == 0) {
+				if (offset_x == -1) {
+					neighbors = *dirNeighbors[DIRECTION_WEST];
+				} else {
+					neighbors = *dirNeighbors[DIRECTION_EAST];
+				}
+			} else if (!fpp.allowDiagonal || offset_x == 0) {
+				if (offset_y == -1) {
+					neighbors = *dirNeighbors[DIRECTION_NORTH];
+				} else {
+					neighbors = *dirNeighbors[DIRECTION_SOUTH];
+				}
+			} else if (offset_y == -1) {
+				if (offset_x == -1) {
+					neighbors = *dirNeighbors[DIRECTION_NORTHWEST];
+				} else {
+					neighbors = *dirNeighbors[DIRECTION_NORTHEAST];
+				}
+			} else if (offset_x == -1) {
+				neighbors = *dirNeighbors[DIRECTION_SOUTHWEST];
+			} else {
+				neighbors = *dirNeighbors[DIRECTION_SOUTHEAST];
+			}
+			dirCount = fpp.allowDiagonal ? 5 : 3;
+		} else {
+			dirCount = 8;
+			neighbors = *allNeighbors;
+		}
+
+		const int_fast32_t f = n->f;
+		for (uint_fast32_t i = 0; i < dirCount; ++i) {
+			pos.x = x + *neighbors++;
+			pos.y = y + *neighbors++;
+
+			if (fpp.maxSearchDist != 0 &&
+			    (startPos.getDistanceX(pos) > fpp.maxSearchDist || startPos.getDistanceY(pos) > fpp.maxSearchDist)) {
+				continue;
+			}
+
+			if (fpp.keepDistance && !pathCondition.isInRange(startPos, pos, fpp)) {
+				continue;
+			}
+
+			const Tile* tile;
+			AStarNode* neighborNode = nodes.getNodeByPosition(pos.x, pos.y);
+			if (neighborNode) {
+				tile = map.getTile(pos.x, pos.y, pos.z);
+			} else {
+				tile = map.canWalkTo(creature, pos);
+				if (!tile) {
+					continue;
+				}
+			}
+
+			// The cost (g) for this neighbor
+			const int_fast32_t cost = AStarNodes::getMapWalkCost(n, pos);
+			const int_fast32_t extraCost = AStarNodes::getTileWalkCost(creature, tile);
+			const int_fast32_t newf = f + cost + extraCost;
+
+			if (neighborNode) {
+				if (neighborNode->f <= newf) {
+					// The node on the closed/open list is cheaper than this one
+					continue;
+				}
+
+				neighborNode->f = newf;
+				neighborNode->parent = n;
+				nodes.openNode(neighborNode);
+			} else {
+				// Does not exist in the open/closed list, create a new node
+				neighborNode = nodes.createOpenNode(n, pos.x, pos.y, newf);
+				if (!neighborNode) {
+					if (found) {
+						break;
+					}
+					return false;
+				}
+			}
+		}
+
+		nodes.closeNode(n);
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	int32_t prevx = endPos.getX();
+	int32_t prevy = endPos.getY();
+
+	found = found->parent;
+	while (found) {
+		pos.x = found->x;
+		pos.y = found->y;
+
+		int32_t dx = pos.getX() - prevx;
+		int32_t dy = pos.getY() - prevy;
+
+		prevx = pos.x;
+		prevy = pos.y;
+
+		if (dx == 1 && dy == 1) {
+			dirList.push_back(DIRECTION_NORTHWEST);
+		} else if (dx == -1 && dy == 1) {
+			dirList.push_back(DIRECTION_NORTHEAST);
+		} else if (dx == 1 && dy == -1) {
+			dirList.push_back(DIRECTION_SOUTHWEST);
+		} else if (dx == -1 && dy == -1) {
+			dirList.push_back(DIRECTION_SOUTHEAST);
+		} else if (dx == 1) {
+			dirList.push_back(DIRECTION_WEST);
+		} else if (dx == -1) {
+			dirList.push_back(DIRECTION_EAST);
+		} else if (dy == 1) {
+			dirList.push_back(DIRECTION_NORTH);
+		} else if (dy == -1) {
+			dirList.push_back(DIRECTION_SOUTH);
+		}
+
+		found = found->parent;
+	}
+	return true;
+}
+
+struct PathQuery
+{
+	Tile* start;
+	Position target;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::string dataDir = argc > 1 ? argv[1] : "data";
+	size_t queryCount = argc > 2 ? std::stoul(argv[2]) : 20'000;
+
+	if (!Item::items.loadFromOtb(dataDir + "/items/items.otb")) {
+		fmt::print(stderr, "Unable to load items.otb\n");
+		return 1;
+	}
+
+	IOMap loader;
+	if (!loader.loadMap(&g_game.map, dataDir + "/world/forgotten.otbm")) {
+		fmt::print(stderr, "Unable to load forgotten.otbm: {}\n", loader.getLastErrorString());
+		return 1;
+	}
+
+	PathfindingCreature creature;
+
+	// every walkable tile of the map is a possible start, targets are picked within the viewport
+	std::vector<Tile*> walkable;
+	for (uint32_t sectorX = 0; sectorX < 0x10000; sectorX += SECTOR_SIZE) {
+		for (uint32_t sectorY = 0; sectorY < 0x10000; sectorY += SECTOR_SIZE) {
+			if (!g_game.map.getMapSector(sectorX, sectorY)) {
+				continue;
+			}
+
+			for (uint16_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+				for (uint32_t x = sectorX; x < sectorX + SECTOR_SIZE; ++x) {
+					for (uint32_t y = sectorY; y < sectorY + SECTOR_SIZE; ++y) {
+						Tile* tile = g_game.map.getTile(x, y, z);
+						if (tile && tile->getGround() &&
+						    tile->queryAdd(0, creature, 1, FLAG_PATHFINDING) == RETURNVALUE_NOERROR) {
+							walkable.push_back(tile);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (walkable.empty()) {
+		fmt::print(stderr, "No walkable tiles found\n");
+		return 1;
+	}
+
+	std::mt19937 rng(0xdeadbeef);
+	std::uniform_int_distribution<size_t> randomTile(0, walkable.size() - 1);
+	std::uniform_int_distribution<int32_t> randomOffset(-Map::maxClientViewportX, Map::maxClientViewportX);
+
+	std::vector<PathQuery> queries;
+	queries.reserve(queryCount);
+	while (queries.size() < queryCount) {
+		Tile* start = walkable[randomTile(rng)];
+		const Position& pos = start->getPosition();
+		queries.push_back({start, Position(pos.x + randomOffset(rng), pos.y + randomOffset(rng), pos.z)});
+	}
+
+	FindPathParams fpp;
+	fpp.fullPathSearch = true;
+	fpp.clearSight = true;
+	fpp.maxSearchDist = 12;
+	fpp.minTargetDist = 1;
+	fpp.maxTargetDist = 1;
+
+	size_t legacyFound = 0, currentFound = 0;
+	std::vector<Direction> dirList;
+	auto runQueries = [&](auto&& search, size_t& found) {
+		for (const PathQuery& query : queries) {
+			query.start->internalAddThing(&creature);
+			dirList.clear();
+			if (search(FrozenPathingConditionCall(query.target))) {
+				++found;
+			}
+			query.start->removeThing(&creature, 0);
+		}
+	};
+
+	fmt::print("{} walkable tiles, {} queries\n", walkable.size(), queries.size());
+
+	double legacy = benchmark::run("linear scan + unordered_map", queries.size(), [&]() {
+		runQueries(
+		    [&](const FrozenPathingConditionCall& condition) {
+			    return legacyGetPathMatching(g_game.map, creature, dirList, condition, fpp);
+		    },
+		    legacyFound);
+	});
+
+	double current = benchmark::run("binary heap + open addressing", queries.size(), [&]() {
+		runQueries(
+		    [&](const FrozenPathingConditionCall& condition) {
+			    return g_game.map.getPathMatching(creature, dirList, condition, fpp);
+		    },
+		    currentFound);
+	});
+
+	fmt::print("paths found: {} / {}, speedup: {:.2f}x\n", legacyFound, currentFound, current / legacy);
+	return 0;
+}
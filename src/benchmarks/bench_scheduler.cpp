@@ -0,0 +1,140 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../scheduler.h"
+#include "benchmark.h"
+
+#include <future>
+
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+// Scheduler before the timing wheel, one steady_timer per event, kept here as the baseline.
+class LegacyScheduler : public ThreadHolder<LegacyScheduler>
+{
+public:
+	uint32_t addEvent(SchedulerTask* task)
+	{
+		if (task->getEventId() == 0) {
+			task->setEventId(++lastEventId);
+		}
+
+		boost::asio::post(io_context, [this, task]() {
+			auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
+			auto& timer = it.first->second;
+
+			timer.expires_after(std::chrono::milliseconds(task->getDelay()));
+			timer.async_wait([this, task](const boost::system::error_code& error) {
+				eventIdTimerMap.erase(task->getEventId());
+
+				if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
+					delete task;
+					return;
+				}
+
+				g_dispatcher.addTask(task);
+			});
+		});
+
+		return task->getEventId();
+	}
+
+	void stopEvent(uint32_t eventId)
+	{
+		boost::asio::post(io_context, [this, eventId]() {
+			auto it = eventIdTimerMap.find(eventId);
+			if (it != eventIdTimerMap.end()) {
+				it->second.cancel();
+			}
+		});
+	}
+
+	void shutdown()
+	{
+		setState(THREAD_STATE_TERMINATED);
+		boost::asio::post(io_context, [this]() {
+			for (auto& it : eventIdTimerMap) {
+				it.second.cancel();
+			}
+
+			io_context.stop();
+		});
+	}
+
+	void threadMain() { io_context.run(); }
+
+private:
+	std::atomic<uint32_t> lastEventId{0};
+	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
+	boost::asio::io_context io_context;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
+};
+
+// Blocks until every command given to the scheduler before has been handled.
+template <class SchedulerType>
+void waitForScheduler(SchedulerType& scheduler)
+{
+	std::promise<void> done;
+	scheduler.addEvent(createSchedulerTask(0, [&done]() { done.set_value(); }));
+	done.get_future().wait();
+}
+
+template <class SchedulerType>
+void runBenchmarks(std::string_view name, uint32_t eventCount, double& insertCancel, double& fire)
+{
+	SchedulerType scheduler;
+	scheduler.start();
+
+	std::vector<uint32_t> eventIds(eventCount);
+	insertCancel = benchmark::run(fmt::format("{}: insert + cancel", name), eventCount, [&]() {
+		for (uint32_t i = 0; i < eventCount; ++i) {
+			eventIds[i] = scheduler.addEvent(createSchedulerTask(60'000 + i % 60'000, []() {}));
+		}
+		for (uint32_t eventId : eventIds) {
+			scheduler.stopEvent(eventId);
+		}
+		waitForScheduler(scheduler);
+	});
+
+	// events spread over the first 10 ms, the time until the last one ran on the dispatcher
+	std::atomic<uint32_t> fired = 0;
+	std::promise<void> allFired;
+	fire = benchmark::run(fmt::format("{}: insert + fire", name), eventCount, [&]() {
+		for (uint32_t i = 0; i < eventCount; ++i) {
+			scheduler.addEvent(createSchedulerTask(i % 10, [&]() {
+				if (++fired == eventCount) {
+					allFired.set_value();
+				}
+			}));
+		}
+		allFired.get_future().wait();
+	});
+
+	scheduler.shutdown();
+	scheduler.join();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	uint32_t eventCount = argc > 1 ? std::stoul(argv[1]) : 100'000;
+
+	g_dispatcher.start();
+
+	double legacyInsertCancel, legacyFire;
+	runBenchmarks<LegacyScheduler>("steady_timer per event", eventCount, legacyInsertCancel, legacyFire);
+
+	double wheelInsertCancel, wheelFire;
+	runBenchmarks<Scheduler>("timing wheel", eventCount, wheelInsertCancel, wheelFire);
+
+	fmt::print("speedup: insert + cancel {:.2f}x, insert + fire {:.2f}x\n", wheelInsertCancel / legacyInsertCancel,
+	           wheelFire / legacyFire);
+
+	g_dispatcher.shutdown();
+	g_dispatcher.join();
+	return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../game.h"
+#include "../iomap.h"
+#include "benchmark.h"
+
+extern Game g_game;
+
+namespace {
+
+// Map::isTileClear and checkSightLine before the blocking bitmaps and ray tables, kept here as the baseline.
+bool legacyIsTileClear(const Map& map, uint16_t x, uint16_t y, uint8_t z)
+{
+	const Tile* tile = map.getTile(x, y, z);
+	return !tile || !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
+}
+
+bool legacyCheckSteepLine(const Map& map, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+{
+	float dx = x1 - x0;
+	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
+	float yi = y0 + slope;
+
+	for (uint16_t x = x0 + 1; x < x1; ++x) {
+		// 0.1 is necessary to avoid loss of precision during calculation
+		if (!legacyIsTileClear(map, std::floor(yi + 0.1), x, z)) {
+			return false;
+		}
+		yi += slope;
+	}
+
+	return true;
+}
+
+bool legacyCheckSlightLine(const Map& map, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+{
+	float dx = x1 - x0;
+	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
+	float yi = y0 + slope;
+
+	for (uint16_t x = x0 + 1; x < x1; ++x) {
+		// 0.1 is necessary to avoid loss of precision during calculation
+		if (!legacyIsTileClear(map, x, std::floor(yi + 0.1), z)) {
+			return false;
+		}
+		yi += slope;
+	}
+
+	return true;
+}
+
+bool legacyIsSightClear(const Map& map, const Position& fromPos, const Position& toPos)
+{
+	if (fromPos.z != toPos.z) {
+		return false;
+	}
+
+	if (fromPos.getDistanceX(toPos) < 2 && fromPos.getDistanceY(toPos) < 2) {
+		return true;
+	}
+
+	const uint16_t x0 = fromPos.x, y0 = fromPos.y, x1 = toPos.x, y1 = toPos.y;
+	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
+		if (y1 > y0) {
+			return legacyCheckSteepLine(map, y0, x0, y1, x1, fromPos.z);
+		}
+		return legacyCheckSteepLine(map, y1, x1, y0, x0, fromPos.z);
+	}
+
+	if (x0 > x1) {
+		return legacyCheckSlightLine(map, x1, y1, x0, y0, fromPos.z);
+	}
+	return legacyCheckSlightLine(map, x0, y0, x1, y1, fromPos.z);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::string dataDir = argc > 1 ? argv[1] : "data";
+	size_t originCount = argc > 2 ? std::stoul(argv[2]) : 20'000;
+
+	if (!Item::items.loadFromOtb(dataDir + "/items/items.otb")) {
+		fmt::print(stderr, "Unable to load items.otb\n");
+		return 1;
+	}
+
+	IOMap loader;
+	if (!loader.loadMap(&g_game.map, dataDir + "/world/forgotten.otbm")) {
+		fmt::print(stderr, "Unable to load forgotten.otbm: {}\n", loader.getLastErrorString());
+		return 1;
+	}
+
+	// monsters and area spells look from a tile with ground at the tiles around it
+	std::vector<Position> origins;
+	for (uint32_t sectorX = 0; sectorX < 0x10000; sectorX += SECTOR_SIZE) {
+		for (uint32_t sectorY = 0; sectorY < 0x10000; sectorY += SECTOR_SIZE) {
+			if (!g_game.map.getMapSector(sectorX, sectorY)) {
+				continue;
+			}
+
+			for (uint16_t z = 0; z < MAP_MAX_LAYERS; ++z) {
+				for (uint32_t x = sectorX; x < sectorX + SECTOR_SIZE; ++x) {
+					for (uint32_t y = sectorY; y < sectorY + SECTOR_SIZE; ++y) {
+						const Tile* tile = g_game.map.getTile(x, y, z);
+						if (tile && tile->getGround() && !tile->hasFlag(TILESTATE_BLOCKSOLID)) {
+							origins.emplace_back(x, y, z);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (origins.empty()) {
+		fmt::print(stderr, "No origins found\n");
+		return 1;
+	}
+
+	std::mt19937 rng(0xdeadbeef);
+	std::shuffle(origins.begin(), origins.end(), rng);
+	origins.resize(std::min(origins.size(), originCount));
+
+	// every tile within the client viewport of the origin
+	std::vector<std::vector<Position>> targets(origins.size());
+	size_t targetCount = 0;
+	for (size_t i = 0; i < origins.size(); ++i) {
+		const Position& origin = origins[i];
+		for (int32_t dy = -Map::maxClientViewportY; dy <= Map::maxClientViewportY; ++dy) {
+			for (int32_t dx = -Map::maxClientViewportX; dx <= Map::maxClientViewportX; ++dx) {
+				targets[i].emplace_back(origin.x + dx, origin.y + dy, origin.z);
+			}
+		}
+		targetCount += targets[i].size();
+	}
+
+	fmt::print("{} origins, {} lines\n", origins.size(), targetCount);
+
+	size_t legacyClear = 0, singleClear = 0, batchedClear = 0, mismatches = 0;
+	std::vector<std::vector<bool>> singleResults(origins.size());
+
+	double legacy = benchmark::run("per tile getTile + hasProperty", targetCount, [&]() {
+		for (size_t i = 0; i < origins.size(); ++i) {
+			for (const Position& target : targets[i]) {
+				legacyClear += legacyIsSightClear(g_game.map, origins[i], target);
+			}
+		}
+	});
+
+	double single = benchmark::run("single isSightClear, bitmaps + rays", targetCount, [&]() {
+		for (size_t i = 0; i < origins.size(); ++i) {
+			for (const Position& target : targets[i]) {
+				bool clear = g_game.map.isSightClear(origins[i], target, true);
+				singleResults[i].push_back(clear);
+				singleClear += clear;
+			}
+		}
+	});
+
+	std::vector<bool> results;
+	double batched = benchmark::run("batched isSightClear", targetCount, [&]() {
+		for (size_t i = 0; i < origins.size(); ++i) {
+			g_game.map.isSightClear(origins[i], targets[i], results, true);
+			batchedClear += std::count(results.begin(), results.end(), true);
+			mismatches += results != singleResults[i];
+		}
+	});
+
+	fmt::print("clear lines: {} / {} / {}, origins where batched and single differ: {}\n", legacyClear, singleClear,
+	           batchedClear, mismatches);
+	fmt::print("speedup: single {:.2f}x, batched {:.2f}x\n", single / legacy, batched / legacy);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "../otpch.h"
+
+#include "../const.h"
+#include "../xtea.h"
+#include "benchmark.h"
+
+int main(int argc, char* argv[])
+{
+	size_t totalBytes = argc > 1 ? std::stoul(argv[1]) : 256 << 20;
+
+	std::mt19937 rng(0xdeadbeef);
+	std::uniform_int_distribution<uint32_t> words;
+	auto key = xtea::expand_key({words(rng), words(rng), words(rng), words(rng)});
+
+	fmt::print("selected kernel: {}\n", xtea::kernel_name(xtea::best_kernel()));
+
+	// a small update, a typical game packet and the largest possible message
+	bool mismatch = false;
+	for (size_t length : {32, 512, NETWORKMESSAGE_MAXSIZE / 8 * 8}) {
+		std::vector<uint8_t> plain(length);
+		std::generate(plain.begin(), plain.end(), [&]() { return static_cast<uint8_t>(words(rng)); });
+
+		std::vector<uint8_t> expected = plain;
+		xtea::encrypt(expected.data(), expected.size(), key, xtea::kernel::scalar);
+
+		size_t messages = std::max<size_t>(totalBytes / length, 1);
+		for (auto impl : {xtea::kernel::scalar, xtea::kernel::sse2, xtea::kernel::avx2, xtea::kernel::neon}) {
+			if (!xtea::is_supported(impl)) {
+				continue;
+			}
+
+			std::vector<uint8_t> data = plain;
+			benchmark::run(fmt::format("{} encrypt, {} byte messages (bytes)", xtea::kernel_name(impl), length),
+			               messages * length, [&]() {
+				               for (size_t i = 0; i < messages; ++i) {
+					               xtea::encrypt(data.data(), data.size(), key, impl);
+				               }
+				               benchmark::doNotOptimize(data);
+			               });
+
+			// a round trip after the benchmark has to give the scalar result again
+			data = plain;
+			xtea::encrypt(data.data(), data.size(), key, impl);
+			mismatch |= data != expected;
+		}
+	}
+
+	if (mismatch) {
+		fmt::print(stderr, "vector output differs from the scalar kernel\n");
+	}
+	return mismatch ? 1 : 0;
+}
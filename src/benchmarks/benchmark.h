@@ -0,0 +1,39 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_BENCHMARK_H
+#define FS_BENCHMARK_H
+
+#include <chrono>
+#include <fmt/format.h>
+
+namespace benchmark {
+
+// Keeps the compiler from optimizing away a value computed by the benchmark body.
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const T* sink;
+	sink = &value;
+#endif
+}
+
+// Runs func(), which performs `operations` units of work, and prints the throughput.
+template <class Func>
+double run(std::string_view name, uint64_t operations, Func&& func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double perSecond = operations / elapsed.count();
+	fmt::print("{:<48} {:>10.3f} ms {:>14.0f} ops/s\n", name, elapsed.count() * 1000, perSecond);
+	return perSecond;
+}
+
+} // namespace benchmark
+
+#endif // FS_BENCHMARK_H
@@ -23,22 +23,30 @@ std::vector<Tile*> getList(const MatrixArea& area, const Position& targetPos, co
 
 	auto& center = area.getCenter();
 
+	std::vector<Position> positions;
 	Position tmpPos(targetPos.x - center.first, targetPos.y - center.second, targetPos.z);
 	for (uint32_t row = 0; row < area.getRows(); ++row, ++tmpPos.y) {
 		for (uint32_t col = 0; col < area.getCols(); ++col, ++tmpPos.x) {
 			if (area(row, col)) {
-				if (g_game.isSightClear(casterPos, tmpPos, true)) {
-					Tile* tile = g_game.map.getTile(tmpPos);
-					if (!tile) {
-						tile = new StaticTile(tmpPos.x, tmpPos.y, tmpPos.z);
-						g_game.map.setTile(tmpPos, tile);
-					}
-					vec.push_back(tile);
-				}
+				positions.push_back(tmpPos);
 			}
 		}
 		tmpPos.x -= static_cast<uint16_t>(area.getCols());
 	}
+
+	std::vector<bool> sightClear;
+	g_game.map.isSightClear(casterPos, positions, sightClear, true);
+
+	for (size_t i = 0, size = positions.size(); i < size; ++i) {
+		if (sightClear[i]) {
+			Tile* tile = g_game.map.getTile(positions[i]);
+			if (!tile) {
+				tile = new StaticTile(positions[i].x, positions[i].y, positions[i].z);
+				g_game.map.setTile(positions[i], tile);
+			}
+			vec.push_back(tile);
+		}
+	}
 	return vec;
 }
 
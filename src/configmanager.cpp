@@ -187,7 +187,6 @@ void loadDefaults()
 {
 	// ... existing defaults
 
-	setDefault(NETWORK_QUEUE_SIZE, "100");
 	setDefault(ITEM_POOL_SIZE, "1000");
 }
 
@@ -281,6 +280,8 @@ bool load()
 	booleans[Boolean::MONSTER_OVERSPAWN] = getGlobalBoolean(L, "monsterOverspawn", false);
 	booleans[Boolean::ACCOUNT_MANAGER] = getGlobalBoolean(L, "accountManager", true);
 	booleans[Boolean::MANASHIELD_BREAKABLE] = getGlobalBoolean(L, "useBreakableManaShield", false);
+	booleans[Boolean::HIERARCHICAL_PATHFINDING] = getGlobalBoolean(L, "hierarchicalPathfinding", false);
+	booleans[Boolean::TASK_STATISTICS] = getGlobalBoolean(L, "taskStatistics", false);
 
 	strings[String::DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	strings[String::SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -345,8 +346,12 @@ bool load()
 	    getGlobalInteger(L, "RANGE_USE_ITEM_EX_INTERVAL", RANGE_USE_ITEM_EX_INTERVAL);
 	integers[Integer::RANGE_ROTATE_ITEM_INTERVAL] =
 	    getGlobalInteger(L, "RANGE_ROTATE_ITEM_INTERVAL", RANGE_ROTATE_ITEM_INTERVAL);
-	integers[Integer::NETWORK_QUEUE_SIZE] = getGlobalInteger(L, "networkQueueSize", 100);
 	integers[Integer::ITEM_POOL_SIZE] = getGlobalInteger(L, "itemPoolSize", 1000);
+	integers[Integer::GAME_TICK_INTERVAL] = getGlobalInteger(L, "gameTickInterval", 0);
+	integers[Integer::WORKER_THREADS] = getGlobalInteger(L, "workerThreads", -1);
+	integers[Integer::NETWORK_THREADS] = getGlobalInteger(L, "networkThreads", -1);
+	integers[Integer::PACKET_COMPRESSION_LEVEL] = getGlobalInteger(L, "packetCompressionLevel", 6);
+	integers[Integer::PACKET_COMPRESSION_THRESHOLD] = getGlobalInteger(L, "packetCompressionThreshold", 128);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
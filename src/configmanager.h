@@ -48,6 +48,8 @@ enum Boolean
 	MONSTER_OVERSPAWN,
 	ACCOUNT_MANAGER,
 	MANASHIELD_BREAKABLE,
+	HIERARCHICAL_PATHFINDING,
+	TASK_STATISTICS,
 
 	LAST_BOOLEAN /* this must be the last one */
 };
@@ -128,8 +130,12 @@ enum Integer
 	RANGE_USE_ITEM_INTERVAL,
 	RANGE_USE_ITEM_EX_INTERVAL,
 	RANGE_ROTATE_ITEM_INTERVAL,
-	NETWORK_QUEUE_SIZE,
 	ITEM_POOL_SIZE,
+	GAME_TICK_INTERVAL,
+	WORKER_THREADS,
+	NETWORK_THREADS,
+	PACKET_COMPRESSION_LEVEL,
+	PACKET_COMPRESSION_THRESHOLD,
 
 	LAST_INTEGER /* this must be the last one */
 };
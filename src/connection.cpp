@@ -45,26 +45,35 @@ void ConnectionManager::closeAll()
 
 // Connection
 
+Connection::Connection(boost::asio::io_context& io_context, ConstServicePort_ptr service_port) :
+    strand(boost::asio::make_strand(io_context)),
+    readTimer(strand),
+    writeTimer(strand),
+    sendQueue(CONNECTION_SEND_QUEUE_SIZE),
+    service_port(std::move(service_port)),
+    socket(strand),
+    timeConnected(time(nullptr))
+{}
+
 void Connection::close(bool force)
 {
 	// any thread
 	ConnectionManager::getInstance().releaseConnection(shared_from_this());
 
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-	if (closed) {
+	if (closed.exchange(true)) {
 		return;
 	}
-	closed = true;
 
 	if (protocol) {
 		g_dispatcher.addTask([protocol = protocol]() { protocol->release(); });
 	}
 
-	if (messageQueue.empty() || force) {
-		closeSocket();
-	} else {
-		// will be closed by the destructor or onWriteOperation
-	}
+	// queued messages are still written first unless forced, the last write then closes the socket
+	boost::asio::dispatch(strand, [thisPtr = shared_from_this(), force]() {
+		if (force || !thisPtr->writing) {
+			thisPtr->closeSocket();
+		}
+	});
 }
 
 void Connection::closeSocket()
@@ -87,14 +96,14 @@ Connection::~Connection() { closeSocket(); }
 void Connection::accept(Protocol_ptr protocol)
 {
 	this->protocol = protocol;
-	g_dispatcher.addTask([=]() { protocol->onConnect(); });
-
 	accept();
+
+	// whatever onConnect sends is written on the strand, so the first read has to be started before
+	g_dispatcher.addTask([=]() { protocol->onConnect(); });
 }
 
 void Connection::accept()
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	try {
 		readTimer.expires_after(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		readTimer.async_wait(
@@ -116,7 +125,6 @@ void Connection::accept()
 
 void Connection::parseHeader(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -166,7 +174,6 @@ void Connection::parseHeader(const boost::system::error_code& error)
 
 void Connection::parsePacket(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -233,21 +240,91 @@ void Connection::parsePacket(const boost::system::error_code& error)
 
 void Connection::send(const OutputMessage_ptr& msg)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	if (closed) {
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
-	messageQueue.emplace_back(msg);
-	if (noPendingWrite) {
-		internalSend(msg);
+	if (strand.running_in_this_thread()) {
+		// the strand does the writing, so messages sent from it can be queued right away
+		localSendQueue.push_back(msg);
+		if (!writing.exchange(true)) {
+			internalSend();
+		}
+		return;
+	}
+
+	if (pendingOverflow.load(std::memory_order_acquire) != 0 || !sendQueue.push(msg)) {
+		// the client is behind by the whole ring, the strand keeps the rest until the write timeout gives up on it
+		pendingOverflow.fetch_add(1, std::memory_order_relaxed);
+		overflowBacklog.fetch_add(1, std::memory_order_relaxed);
+		boost::asio::post(strand, [thisPtr = shared_from_this(), msg]() { thisPtr->addOverflowMessage(msg); });
+		return;
+	}
+
+	if (!writing.exchange(true)) {
+		boost::asio::post(strand, [thisPtr = shared_from_this()]() { thisPtr->internalSend(); });
+	}
+}
+
+void Connection::addOverflowMessage(const OutputMessage_ptr& msg)
+{
+	// strand, no message was pushed to the ring since msg was posted, so everything in it is older
+	OutputMessage_ptr queued;
+	while (sendQueue.pop(queued)) {
+		overflowQueue.push_back(std::move(queued));
+		overflowBacklog.fetch_add(1, std::memory_order_relaxed);
+	}
+	overflowQueue.push_back(msg);
+	pendingOverflow.fetch_sub(1, std::memory_order_release);
+
+	if (!closed && !writing.exchange(true)) {
+		internalSend();
 	}
 }
 
-void Connection::internalSend(const OutputMessage_ptr& msg)
+void Connection::takeQueuedMessages()
 {
-	protocol->onSendMessage(msg);
+	for (; !localSendQueue.empty() && writingMessages.size() < CONNECTION_MAX_WRITE_MESSAGES;
+	     localSendQueue.pop_front()) {
+		writingMessages.push_back(std::move(localSendQueue.front()));
+	}
+
+	for (; !overflowQueue.empty() && writingMessages.size() < CONNECTION_MAX_WRITE_MESSAGES;
+	     overflowQueue.pop_front()) {
+		writingMessages.push_back(std::move(overflowQueue.front()));
+		overflowBacklog.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	OutputMessage_ptr msg;
+	while (writingMessages.size() < CONNECTION_MAX_WRITE_MESSAGES && sendQueue.pop(msg)) {
+		writingMessages.push_back(std::move(msg));
+	}
+}
+
+void Connection::internalSend()
+{
+	// strand, writing is set
+	takeQueuedMessages();
+	if (writingMessages.empty()) {
+		writing = false;
+		// a message pushed since the ring was found empty saw writing still set and left it to the strand
+		if (sendQueue.read_available() == 0 || writing.exchange(true)) {
+			if (closed && !writing) {
+				closeSocket();
+			}
+			return;
+		}
+		takeQueuedMessages();
+	}
+
+	// headers and encryption are done as late as possible, then everything goes out in one gather write
+	std::vector<boost::asio::const_buffer> buffers;
+	buffers.reserve(writingMessages.size());
+	for (const OutputMessage_ptr& message : writingMessages) {
+		protocol->onSendMessage(message);
+		buffers.emplace_back(message->getOutputBuffer(), message->getLength());
+	}
+
 	try {
 		writeTimer.expires_after(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 		writeTimer.async_wait(
@@ -256,7 +333,7 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 		    });
 
 		boost::asio::async_write(
-		    socket, boost::asio::buffer(msg->getOutputBuffer(), msg->getLength()),
+		    socket, buffers,
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->onWriteOperation(error);
 		    });
@@ -266,37 +343,30 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 	}
 }
 
-uint32_t Connection::getIP()
+void Connection::resolveIP()
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-
 	// IP-address is expressed in network byte order
 	boost::system::error_code error;
 	const boost::asio::ip::tcp::endpoint endpoint = socket.remote_endpoint(error);
-	if (error) {
-		return 0;
-	}
-
-	return htonl(endpoint.address().to_v4().to_uint());
+	remoteIp = error ? 0 : htonl(endpoint.address().to_v4().to_uint());
 }
 
 void Connection::onWriteOperation(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	writeTimer.cancel();
-	messageQueue.pop_front();
+	writingMessages.clear();
 
 	if (error) {
-		messageQueue.clear();
+		// writing stays set, so the dispatcher does not start another write
+		localSendQueue.clear();
+		overflowQueue.clear();
+		overflowBacklog = 0;
+		sendQueue.consume_all([](const OutputMessage_ptr&) {});
 		close(FORCE_CLOSE);
 		return;
 	}
 
-	if (!messageQueue.empty()) {
-		internalSend(messageQueue.front());
-	} else if (closed) {
-		closeSocket();
-	}
+	internalSend();
 }
 
 void Connection::handleTimeout(ConnectionWeak_ptr connectionWeak, const boost::system::error_code& error)
@@ -10,6 +10,12 @@
 
 inline constexpr int32_t CONNECTION_WRITE_TIMEOUT = 30;
 inline constexpr int32_t CONNECTION_READ_TIMEOUT = 30;
+// queued messages from which on the client is considered behind and droppable messages are left out
+inline constexpr size_t CONNECTION_SEND_BACKLOG = 8;
+// messages taken into one gather write, asio hands at most 64 buffers to a single system call
+inline constexpr size_t CONNECTION_MAX_WRITE_MESSAGES = 64;
+// messages of the dispatcher the lock-free ring holds, more wait in an overflow queue on the strand
+inline constexpr size_t CONNECTION_SEND_QUEUE_SIZE = 1024;
 
 class Protocol;
 using Protocol_ptr = std::shared_ptr<Protocol>;
@@ -56,13 +62,7 @@ public:
 		FORCE_CLOSE = true
 	};
 
-	Connection(boost::asio::io_context& io_context, ConstServicePort_ptr service_port) :
-	    readTimer(io_context),
-	    writeTimer(io_context),
-	    service_port(std::move(service_port)),
-	    socket(io_context),
-	    timeConnected(time(nullptr))
-	{}
+	Connection(boost::asio::io_context& io_context, ConstServicePort_ptr service_port);
 	~Connection();
 
 	friend class ConnectionManager;
@@ -72,9 +72,21 @@ public:
 	void accept(Protocol_ptr protocol);
 	void accept();
 
+	/**
+	 * Queues msg for writing. The dispatcher is the only thread that may call it besides the strand of the
+	 * connection; its messages go through a lock-free ring that the strand drains, so neither waits for the other.
+	 * Once the ring is full they are posted to the strand instead, only the write timeout disconnects a slow client.
+	 */
 	void send(const OutputMessage_ptr& msg);
+	// messages sent by the dispatcher that are not written yet, only meaningful on the dispatcher
+	size_t getSendBacklog() const
+	{
+		return CONNECTION_SEND_QUEUE_SIZE - sendQueue.write_available() +
+		       overflowBacklog.load(std::memory_order_relaxed);
+	}
 
-	uint32_t getIP();
+	// address of the client when the connection was accepted
+	uint32_t getIP() const { return remoteIp; }
 	uint32_t getLastIp() const { return lastIp; }
 
 private:
@@ -86,19 +98,38 @@ private:
 	static void handleTimeout(ConnectionWeak_ptr connectionWeak, const boost::system::error_code& error);
 
 	void closeSocket();
-	void internalSend(const OutputMessage_ptr& msg);
+	void resolveIP();
+	// writes everything that is queued at once, or marks the connection idle if there is nothing
+	void internalSend();
+	void takeQueuedMessages();
+	void addOverflowMessage(const OutputMessage_ptr& msg);
 
 	boost::asio::ip::tcp::socket& getSocket() { return socket; }
 	friend class ServicePort;
 
 	NetworkMessage msg;
 
+	// runs every handler of the connection, so only close and send need to care about other threads
+	boost::asio::strand<boost::asio::io_context::executor_type> strand;
+
 	boost::asio::steady_timer readTimer;
 	boost::asio::steady_timer writeTimer;
 
-	std::recursive_mutex connectionLock;
-
-	std::list<OutputMessage_ptr> messageQueue;
+	// written by the dispatcher, read by the strand
+	boost::lockfree::spsc_queue<OutputMessage_ptr> sendQueue;
+	// messages sent from the strand itself, they go out before those of the dispatcher
+	std::deque<OutputMessage_ptr> localSendQueue;
+	// messages of the dispatcher that did not fit into sendQueue, strand only, older than everything in sendQueue
+	std::deque<OutputMessage_ptr> overflowQueue;
+	// messages posted to the strand that have not reached overflowQueue yet, the dispatcher only pushes to sendQueue
+	// again once none are left, which keeps its messages in order
+	std::atomic<size_t> pendingOverflow{0};
+	// messages in overflowQueue or on their way there
+	std::atomic<size_t> overflowBacklog{0};
+	// kept alive until their write completed
+	std::vector<OutputMessage_ptr> writingMessages;
+	// set while messages are being written or a write is about to be started
+	std::atomic<bool> writing{false};
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
@@ -107,9 +138,10 @@ private:
 
 	time_t timeConnected;
 	uint32_t packetsSent = 0;
+	uint32_t remoteIp = 0;
 	uint32_t lastIp = 0;
 
-	bool closed = false;
+	std::atomic<bool> closed{false};
 	bool receivedFirst = false;
 };
 
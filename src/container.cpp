@@ -71,7 +71,7 @@ bool Container::unserializeItemNode(OTB::Loader& loader, const OTB::Node& node,
 		return false;
 	}
 
-	for (auto& itemNode : node.children) {
+	for (auto& itemNode : node.children()) {
 		// load container items
 		if (itemNode.type != OTBM_ITEM) {
 			// unknown type
@@ -7,6 +7,7 @@
 
 #include "configmanager.h"
 #include "events.h"
+#include "flowfield.h"
 #include "game.h"
 #include "monster.h"
 #include "scheduler.h"
@@ -144,6 +145,7 @@ void Creature::onThink(uint32_t interval)
 		isUpdatingPath = false;
 		goToFollowCreature();
 	}
+	followPathPlan.followId = 0;
 
 	// scripting event - onThink
 	const CreatureEventList& thinkEvents = getCreatureEvents(CREATURE_EVENT_THINK);
@@ -284,13 +286,22 @@ void Creature::addEventWalk(bool firstStep)
 		g_game.checkCreatureWalk(getID());
 	}
 
-	eventWalk = g_scheduler.addEvent(createSchedulerTask(ticks, [id = getID()]() { g_game.checkCreatureWalk(id); }));
+	if (g_game.hasFixedTick()) {
+		eventWalk = g_game.addWalkEvent(ticks, getID());
+	} else {
+		eventWalk = g_scheduler.addEvent(createSchedulerTask(
+		    ticks, [id = getID()]() { g_game.checkCreatureWalk(id); }, {TASK_CATEGORY_CREATURE}));
+	}
 }
 
 void Creature::stopEventWalk()
 {
 	if (eventWalk != 0) {
-		g_scheduler.stopEvent(eventWalk);
+		if (g_game.hasFixedTick()) {
+			g_game.stopWalkEvent(eventWalk);
+		} else {
+			g_scheduler.stopEvent(eventWalk);
+		}
 		eventWalk = 0;
 	}
 }
@@ -606,7 +617,7 @@ void Creature::onCreatureMove(Creature* creature, const Tile* newTile, const Pos
 		} else {
 			if (hasExtraSwing()) {
 				// our target is moving lets see if we can get in hit
-				g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); });
+				g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); }, {TASK_CATEGORY_CREATURE});
 			}
 
 			if (newTile->getZone() != oldTile->getZone()) {
@@ -792,7 +803,7 @@ void Creature::changeHealth(int32_t healthChange, bool sendHealthChange /* = tru
 	}
 
 	if (isDead()) {
-		g_dispatcher.addTask([id = getID()]() { g_game.executeDeath(id); });
+		g_dispatcher.addTask([id = getID()]() { g_game.executeDeath(id); }, {TASK_CATEGORY_CREATURE});
 	}
 }
 
@@ -936,10 +947,8 @@ void Creature::goToFollowCreature()
 
 	if (followCreature) {
 		FindPathParams fpp;
-		getPathSearchParams(followCreature, fpp);
-
-		Monster* monster = getMonster();
-		if (monster && !monster->getMaster() && (monster->isFleeing() || fpp.maxTargetDist > 1)) {
+		if (!getFollowPathParams(fpp)) {
+			Monster* monster = getMonster();
 			Direction dir = DIRECTION_NONE;
 
 			if (monster->isFleeing()) {
@@ -966,8 +975,14 @@ void Creature::goToFollowCreature()
 				startAutoWalk();
 			}
 		} else {
-			listWalkDir.clear();
-			if (getPathTo(followCreature->getPosition(), listWalkDir, fpp)) {
+			bool found;
+			if (!takeFollowPathPlan(found)) {
+				listWalkDir.clear();
+				found = followCreature->getFollowerPath(*this, listWalkDir, fpp) ||
+				        getPathTo(followCreature->getPosition(), listWalkDir, fpp);
+			}
+
+			if (found) {
 				hasFollowPath = true;
 				startAutoWalk();
 			} else {
@@ -979,6 +994,67 @@ void Creature::goToFollowCreature()
 	onFollowCreatureComplete(followCreature);
 }
 
+bool Creature::getFollowPathParams(FindPathParams& fpp) const
+{
+	getPathSearchParams(followCreature, fpp);
+	// the path is searched again after every step, so the first steps are enough
+	fpp.hierarchical = true;
+
+	// monsters without a master keep their distance or flee by single steps instead
+	const Monster* monster = getMonster();
+	return !monster || monster->getMaster() || (!monster->isFleeing() && fpp.maxTargetDist <= 1);
+}
+
+bool Creature::isFollowPathDue(uint32_t interval) const
+{
+	if (!followCreature || isMovementBlocked()) {
+		return false;
+	}
+	return isUpdatingPath || forceUpdateFollowPath || walkUpdateTicks + interval >= 2000;
+}
+
+bool Creature::planFollowPath()
+{
+	followPathPlan.followId = 0;
+
+	FindPathParams fpp;
+	if (!getFollowPathParams(fpp)) {
+		return false;
+	}
+
+	const uint64_t stamp = g_game.map.getWalkabilityStamp();
+	const FlowField* field = followCreature->flowField.get();
+	bool useField = usesFollowerField(fpp);
+	if (useField && (!field || !field->isValid(g_game.map, followCreature->getPosition()))) {
+		// updating the field is up to the creature that owns it
+		return false;
+	}
+
+	std::vector<Direction>& dirList = followPathPlan.dirList;
+	dirList.clear();
+	followPathPlan.found = (useField && field->getPath(g_game.map, *this, dirList, fpp)) ||
+	                       getPathTo(followCreature->getPosition(), dirList, fpp);
+	followPathPlan.startPos = getPosition();
+	followPathPlan.targetPos = followCreature->getPosition();
+	followPathPlan.stamp = stamp;
+	followPathPlan.followId = followCreature->getID();
+	return true;
+}
+
+bool Creature::takeFollowPathPlan(bool& found)
+{
+	const uint32_t followId = std::exchange(followPathPlan.followId, 0);
+	if (followId == 0 || followId != followCreature->getID() || followPathPlan.startPos != getPosition() ||
+	    followPathPlan.targetPos != followCreature->getPosition() ||
+	    followPathPlan.stamp != g_game.map.getWalkabilityStamp()) {
+		return false;
+	}
+
+	listWalkDir.swap(followPathPlan.dirList);
+	found = followPathPlan.found;
+	return true;
+}
+
 bool Creature::setFollowCreature(Creature* creature)
 {
 	if (creature) {
@@ -1621,9 +1697,39 @@ bool Creature::isInvisible() const
 
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp) const
 {
+	if (fpp.hierarchical) {
+		return g_game.map.getPathHierarchical(*this, dirList, targetPos, fpp);
+	}
 	return g_game.map.getPathMatching(*this, dirList, FrozenPathingConditionCall(targetPos), fpp);
 }
 
+bool Creature::getFollowerPath(const Creature& follower, std::vector<Direction>& dirList, const FindPathParams& fpp)
+{
+	if (!usesFollowerField(fpp)) {
+		return false;
+	}
+
+	updateFollowerField();
+	return flowField->getPath(g_game.map, follower, dirList, fpp);
+}
+
+bool Creature::usesFollowerField(const FindPathParams& fpp)
+{
+	// the field only leads next to this creature
+	return !fpp.keepDistance && fpp.allowDiagonal && fpp.minTargetDist <= 1 && fpp.maxTargetDist == 1;
+}
+
+void Creature::updateFollowerField()
+{
+	if (!flowField) {
+		flowField = std::make_unique<FlowField>();
+	}
+
+	if (!flowField->isValid(g_game.map, position)) {
+		flowField->update(g_game.map, position);
+	}
+}
+
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, int32_t minTargetDist,
                          int32_t maxTargetDist, bool fullPathSearch /*= true*/, bool clearSight /*= true*/,
                          int32_t maxSearchDist /*= 0*/) const
@@ -39,11 +39,13 @@ struct FindPathParams
 	bool clearSight = true;
 	bool allowDiagonal = true;
 	bool keepDistance = false;
+	bool hierarchical = false; // may return only the first steps of a long path, see Map::getPathHierarchical
 	int32_t maxSearchDist = 0;
 	int32_t minTargetDist = -1;
 	int32_t maxTargetDist = -1;
 };
 
+class FlowField;
 class Map;
 class Thing;
 class Container;
@@ -182,6 +184,18 @@ public:
 	Creature* getFollowCreature() const { return followCreature; }
 	virtual bool setFollowCreature(Creature* creature);
 
+	// whether the next think searches a new path towards followCreature
+	bool isFollowPathDue(uint32_t interval) const;
+	/**
+	 * Runs the path search of goToFollowCreature ahead of the think, without changing
+	 * anything but the result kept for it. Safe to call for several creatures at once
+	 * while the map stays untouched, see Game::planFollowPaths.
+	 * \returns false if the search cannot be done ahead, e.g. because it is random
+	 */
+	bool planFollowPath();
+	// brings the flow field of getFollowerPath up to date for the current position
+	void updateFollowerField();
+
 	// follow events
 	virtual void onFollowCreature(const Creature*) {}
 	virtual void onFollowCreatureComplete(const Creature*) {}
@@ -330,6 +344,14 @@ public:
 	               int32_t maxTargetDist, bool fullPathSearch = true, bool clearSight = true,
 	               int32_t maxSearchDist = 0) const;
 
+	/**
+	 * Finds a path for follower towards this creature from the flow field
+	 * shared by everything following it.
+	 * \returns false if the field cannot be used, the caller then has to run its own search
+	 */
+	bool getFollowerPath(const Creature& follower, std::vector<Direction>& dirList, const FindPathParams& fpp);
+	static bool usesFollowerField(const FindPathParams& fpp);
+
 	void incrementReferenceCounter() { ++referenceCounter; }
 	void decrementReferenceCounter()
 	{
@@ -390,6 +412,20 @@ protected:
 	Creature* master = nullptr;
 	Creature* followCreature = nullptr;
 
+	std::unique_ptr<FlowField> flowField;
+
+	// a path found by planFollowPath, used as long as nothing it depends on changed
+	struct FollowPathPlan
+	{
+		std::vector<Direction> dirList;
+		Position startPos;
+		Position targetPos;
+		uint64_t stamp = 0;
+		uint32_t followId = 0;
+		bool found = false;
+	};
+	FollowPathPlan followPathPlan;
+
 	uint64_t lastStep = 0;
 	uint32_t referenceCounter = 0;
 	uint32_t id = 0;
@@ -449,6 +485,8 @@ protected:
 	virtual void dropLoot(Container*, Creature*) {}
 	virtual uint16_t getLookCorpse() const { return 0; }
 	virtual void getPathSearchParams(const Creature* creature, FindPathParams& fpp) const;
+	bool getFollowPathParams(FindPathParams& fpp) const;
+	bool takeFollowPathPlan(bool& found);
 	virtual void death(Creature*) {}
 	virtual bool dropCorpse(Creature* lastHitCreature, Creature* mostDamageCreature, bool lastHitUnjustified,
 	                        bool mostDamageUnjustified);
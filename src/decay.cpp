@@ -0,0 +1,67 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "decay.h"
+
+#include "tools.h"
+
+void DecayWheel::add(Item* item, int64_t deadline)
+{
+	if (currentTick < 0) {
+		currentTick = OTSYS_TIME() / TICK_LENGTH;
+	}
+
+	// the current tick has been handed out already, anything due by now comes up with the next one
+	insert({deadline, item}, std::max(getTick(deadline), currentTick + 1));
+	++count;
+}
+
+void DecayWheel::advance(int64_t time, std::vector<DecayEntry>& expired)
+{
+	const int64_t target = time / TICK_LENGTH;
+	while (currentTick < target) {
+		if (count == 0) {
+			currentTick = target;
+			break;
+		}
+
+		++currentTick;
+		if ((currentTick & WHEEL_MASK) == 0) {
+			const int64_t round = (currentTick >> WHEEL_BITS) & WHEEL_MASK;
+			if (round == 0) {
+				cascade(overflow);
+			}
+			cascade(rounds[round]);
+		}
+
+		auto& slot = ticks[currentTick & WHEEL_MASK];
+		if (!slot.empty()) {
+			count -= slot.size();
+			expired.insert(expired.end(), slot.begin(), slot.end());
+			slot.clear();
+		}
+	}
+}
+
+void DecayWheel::insert(const DecayEntry& entry, int64_t tick)
+{
+	if (tick - currentTick < WHEEL_SIZE) {
+		ticks[tick & WHEEL_MASK].push_back(entry);
+	} else if ((tick >> WHEEL_BITS) - (currentTick >> WHEEL_BITS) < WHEEL_SIZE) {
+		rounds[(tick >> WHEEL_BITS) & WHEEL_MASK].push_back(entry);
+	} else {
+		overflow.push_back(entry);
+	}
+}
+
+void DecayWheel::cascade(std::vector<DecayEntry>& slot)
+{
+	// the overflow list may get some of its entries back, so move them out of the way first
+	cascading.swap(slot);
+	for (const DecayEntry& entry : cascading) {
+		insert(entry, std::max(getTick(entry.deadline), currentTick));
+	}
+	cascading.clear();
+}
@@ -0,0 +1,52 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_DECAY_H
+#define FS_DECAY_H
+
+class Item;
+
+struct DecayEntry
+{
+	int64_t deadline;
+	Item* item;
+};
+
+/**
+ * Decaying items ordered by the OTSYS_TIME their duration runs out, in ticks of TICK_LENGTH ms.
+ * The first wheel holds the next WHEEL_SIZE ticks one slot per tick, the second one WHEEL_SIZE ticks per slot, and
+ * entries further ahead wait in an overflow list. Slots of the second wheel and the overflow list are moved down
+ * when their time comes up, so advancing only touches entries that expire or come close to expiring.
+ */
+class DecayWheel
+{
+public:
+	static constexpr int64_t TICK_LENGTH = 250;
+
+	void add(Item* item, int64_t deadline);
+	// appends the entries whose deadline is at most time
+	void advance(int64_t time, std::vector<DecayEntry>& expired);
+
+	size_t size() const { return count; }
+
+private:
+	static constexpr uint32_t WHEEL_BITS = 8;
+	static constexpr int64_t WHEEL_SIZE = 1 << WHEEL_BITS;
+	static constexpr int64_t WHEEL_MASK = WHEEL_SIZE - 1;
+
+	static int64_t getTick(int64_t deadline) { return (deadline + TICK_LENGTH - 1) / TICK_LENGTH; }
+
+	void insert(const DecayEntry& entry, int64_t tick);
+	void cascade(std::vector<DecayEntry>& slot);
+
+	std::array<std::vector<DecayEntry>, WHEEL_SIZE> ticks;
+	std::array<std::vector<DecayEntry>, WHEEL_SIZE> rounds;
+	std::vector<DecayEntry> overflow;
+	std::vector<DecayEntry> cascading;
+
+	// the last tick handed out by advance, -1 until the first entry comes in
+	int64_t currentTick = -1;
+	size_t count = 0;
+};
+
+#endif // FS_DECAY_H
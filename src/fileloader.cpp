@@ -5,8 +5,6 @@
 
 #include "fileloader.h"
 
-#include <stack>
-
 namespace OTB {
 
 constexpr Identifier wildcard = {{'\0', '\0', '\0', '\0'}};
@@ -25,55 +23,81 @@ Loader::Loader(const std::string& fileName, const Identifier& acceptedIdentifier
 	}
 }
 
-using NodeStack = std::stack<Node*, std::vector<Node*>>;
-static Node& getCurrentNode(const NodeStack& nodeStack)
-{
-	if (nodeStack.empty()) {
-		throw InvalidOTBFormat{};
-	}
-	return *nodeStack.top();
-}
-
 const Node& Loader::parseTree()
 {
 	auto it = fileContents.begin() + sizeof(Identifier);
 	if (static_cast<uint8_t>(*it) != Node::START) {
 		throw InvalidOTBFormat{};
 	}
+
+	// count the nodes first, so that the array is allocated once and never has to be copied while it grows
+	size_t nodeCount = 0;
+	for (auto countIt = it; countIt != fileContents.end(); ++countIt) {
+		// the byte after a node start is its type and the byte after an escape is data, neither can start a node
+		if (static_cast<uint8_t>(*countIt) == Node::START) {
+			++nodeCount;
+		} else if (static_cast<uint8_t>(*countIt) != Node::ESCAPE) {
+			continue;
+		}
+
+		if (++countIt == fileContents.end()) {
+			throw InvalidOTBFormat{};
+		}
+	}
+
+	nodes.clear();
+	nodes.reserve(nodeCount);
+
+	auto& root = nodes.emplace_back();
 	root.type = *(++it);
 	root.propsBegin = ++it;
-	NodeStack parseStack;
-	parseStack.push(&root);
+
+	// indices of the nodes not closed yet; a node has no children so far if it is the last one in the array
+	std::vector<uint32_t> parseStack;
+	parseStack.push_back(0);
 
 	for (; it != fileContents.end(); ++it) {
 		switch (static_cast<uint8_t>(*it)) {
 			case Node::START: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
-					currentNode.propsEnd = it;
+				if (parseStack.empty()) {
+					throw InvalidOTBFormat{};
+				}
+
+				if (parseStack.back() == nodes.size() - 1) {
+					nodes.back().propsEnd = it;
 				}
-				currentNode.children.emplace_back();
-				auto& child = currentNode.children.back();
+
 				if (++it == fileContents.end()) {
 					throw InvalidOTBFormat{};
 				}
+
+				auto& child = nodes.emplace_back();
 				child.type = *it;
 				child.propsBegin = it + sizeof(Node::type);
-				parseStack.push(&child);
+				parseStack.push_back(nodes.size() - 1);
 				break;
 			}
 			case Node::END: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
+				if (parseStack.empty()) {
+					throw InvalidOTBFormat{};
+				}
+
+				auto& currentNode = nodes[parseStack.back()];
+				if (parseStack.back() == nodes.size() - 1) {
 					currentNode.propsEnd = it;
 				}
-				parseStack.pop();
+				currentNode.subtreeSize = nodes.size() - parseStack.back();
+				parseStack.pop_back();
 				break;
 			}
 			case Node::ESCAPE: {
 				if (++it == fileContents.end()) {
 					throw InvalidOTBFormat{};
 				}
+
+				if (!parseStack.empty() && parseStack.back() == nodes.size() - 1) {
+					nodes.back().escaped = true;
+				}
 				break;
 			}
 			default: {
@@ -85,15 +109,22 @@ const Node& Loader::parseTree()
 		throw InvalidOTBFormat{};
 	}
 
-	return root;
+	return nodes.front();
 }
 
-bool Loader::getProps(const Node& node, PropStream& props)
+bool Loader::getProps(const Node& node, PropStream& props) const
 {
 	auto size = std::distance(node.propsBegin, node.propsEnd);
 	if (size == 0) {
 		return false;
 	}
+
+	if (!node.escaped) {
+		props.init(node.propsBegin, size);
+		return true;
+	}
+
+	thread_local std::vector<char> propBuffer;
 	propBuffer.resize(size);
 	bool lastEscaped = false;
 
@@ -11,14 +11,67 @@ using MappedFile = boost::iostreams::mapped_file_source;
 using ContentIt = MappedFile::iterator;
 using Identifier = std::array<char, 4>;
 
+struct Node;
+
+// Iterates the children of a node, which follow it directly in the flat node array.
+class ChildIterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = Node;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const Node*;
+	using reference = const Node&;
+
+	ChildIterator() = default;
+	explicit ChildIterator(const Node* node) : node(node) {}
+
+	const Node& operator*() const { return *node; }
+	const Node* operator->() const { return node; }
+
+	ChildIterator& operator++();
+	ChildIterator operator++(int)
+	{
+		ChildIterator it = *this;
+		++*this;
+		return it;
+	}
+
+	bool operator==(const ChildIterator& other) const = default;
+
+private:
+	const Node* node = nullptr;
+};
+
+class ChildRange
+{
+public:
+	ChildRange(const Node* first, const Node* last) : first(first), last(last) {}
+
+	ChildIterator begin() const { return ChildIterator{first}; }
+	ChildIterator end() const { return ChildIterator{last}; }
+
+	bool empty() const { return first == last; }
+	size_t size() const { return std::distance(begin(), end()); }
+
+private:
+	const Node* first;
+	const Node* last;
+};
+
+// Nodes are stored depth first in one array and point into the mapped file; nothing is copied while parsing.
 struct Node
 {
-	using ChildrenVector = std::vector<Node>;
+	ChildRange children() const { return {this + 1, this + subtreeSize}; }
 
-	ChildrenVector children;
 	ContentIt propsBegin;
 	ContentIt propsEnd;
+	// number of nodes in the subtree of this node, itself included
+	uint32_t subtreeSize = 1;
 	uint8_t type;
+	// whether the props contain escaped bytes, which have to be removed before they can be read
+	bool escaped = false;
+
 	enum NodeChar : uint8_t
 	{
 		ESCAPE = 0xFD,
@@ -27,6 +80,12 @@ struct Node
 	};
 };
 
+inline ChildIterator& ChildIterator::operator++()
+{
+	node += node->subtreeSize;
+	return *this;
+}
+
 struct LoadError : std::exception
 {
 	const char* what() const noexcept override = 0;
@@ -40,12 +99,13 @@ struct InvalidOTBFormat final : LoadError
 class Loader
 {
 	MappedFile fileContents;
-	Node root;
-	std::vector<char> propBuffer;
+	std::vector<Node> nodes;
 
 public:
 	Loader(const std::string& fileName, const Identifier& acceptedIdentifier);
-	bool getProps(const Node& node, PropStream& props);
+	// props points into the mapped file, or for escaped props into a buffer that stays valid until the next call on
+	// the same thread; different threads may read nodes concurrently
+	bool getProps(const Node& node, PropStream& props) const;
 	const Node& parseTree();
 };
 
@@ -0,0 +1,159 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "flowfield.h"
+
+#include "creature.h"
+#include "tools.h"
+
+#include <queue>
+
+namespace {
+
+constexpr int32_t UNREACHABLE = std::numeric_limits<int32_t>::max();
+
+constexpr Direction stepDirections[] = {DIRECTION_NORTH,     DIRECTION_EAST,      DIRECTION_SOUTH,
+                                        DIRECTION_WEST,      DIRECTION_NORTHEAST, DIRECTION_SOUTHEAST,
+                                        DIRECTION_SOUTHWEST, DIRECTION_NORTHWEST};
+
+int32_t getStepCost(Direction dir)
+{
+	return (dir & DIRECTION_DIAGONAL_MASK) != 0 ? MAP_DIAGONALWALKCOST : MAP_NORMALWALKCOST;
+}
+
+} // namespace
+
+int32_t FlowField::getDistance(const Position& pos) const
+{
+	if (pos.z != origin.z) {
+		return UNREACHABLE;
+	}
+
+	const int32_t x = pos.x - origin.x + RADIUS;
+	const int32_t y = pos.y - origin.y + RADIUS;
+	if (x < 0 || x >= SIZE || y < 0 || y >= SIZE) {
+		return UNREACHABLE;
+	}
+	return distances[y * SIZE + x];
+}
+
+bool FlowField::isValid(const Map& map, const Position& origin) const
+{
+	if (stamp == 0 || this->origin != origin) {
+		return false;
+	}
+
+	auto clamp = [](int32_t v) { return static_cast<uint16_t>(std::min<int32_t>(0xFFFF, std::max<int32_t>(0, v))); };
+	return map.isWalkabilityUnchanged(clamp(origin.x - RADIUS), clamp(origin.y - RADIUS), clamp(origin.x + RADIUS),
+	                                  clamp(origin.y + RADIUS), stamp);
+}
+
+void FlowField::update(const Map& map, const Position& origin)
+{
+	this->origin = origin;
+	stamp = map.getWalkabilityStamp();
+	distances.fill(UNREACHABLE);
+
+	using QueueEntry = std::pair<int32_t, Position>;
+	auto compare = [](const QueueEntry& lhs, const QueueEntry& rhs) { return lhs.first > rhs.first; };
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(compare)> queue(compare);
+
+	distances[RADIUS * SIZE + RADIUS] = 0;
+	queue.emplace(0, origin);
+
+	while (!queue.empty()) {
+		const auto [distance, pos] = queue.top();
+		queue.pop();
+
+		if (distance != getDistance(pos)) {
+			continue;
+		}
+
+		for (Direction dir : stepDirections) {
+			const Position nextPos = getNextPosition(dir, pos);
+			const int32_t x = nextPos.x - origin.x + RADIUS;
+			const int32_t y = nextPos.y - origin.y + RADIUS;
+			if (x < 0 || x >= SIZE || y < 0 || y >= SIZE) {
+				continue;
+			}
+
+			// creatures and movable items are left to the followers, see getPath
+			if (!PathGraph::isWalkable(map.getTile(nextPos))) {
+				continue;
+			}
+
+			const int32_t nextDistance = distance + getStepCost(dir);
+			int32_t& currentDistance = distances[y * SIZE + x];
+			if (nextDistance < currentDistance) {
+				currentDistance = nextDistance;
+				queue.emplace(nextDistance, nextPos);
+			}
+		}
+	}
+}
+
+bool FlowField::getPath(const Map& map, const Creature& creature, std::vector<Direction>& dirList,
+                        const FindPathParams& fpp) const
+{
+	const Position startPos = creature.getPosition();
+	Position pos = startPos;
+	int32_t distance = getDistance(pos);
+	if (distance == UNREACHABLE) {
+		return false;
+	}
+
+	std::vector<Direction> steps;
+	while (pos.getDistanceX(origin) > 1 || pos.getDistanceY(origin) > 1) {
+		// every step strictly lowers the distance, so this always terminates
+		Direction bestDir = DIRECTION_NONE;
+		const Tile* bestTile = nullptr;
+		int32_t bestCost = UNREACHABLE;
+		int32_t bestDistance = distance;
+		for (Direction dir : stepDirections) {
+			const Position nextPos = getNextPosition(dir, pos);
+			const int32_t nextDistance = getDistance(nextPos);
+			if (nextDistance >= distance) {
+				continue;
+			}
+
+			if (fpp.maxSearchDist != 0 && (startPos.getDistanceX(nextPos) > fpp.maxSearchDist ||
+			                               startPos.getDistanceY(nextPos) > fpp.maxSearchDist)) {
+				continue;
+			}
+
+			const int32_t cost = nextDistance + getStepCost(dir);
+			if (cost >= bestCost) {
+				continue;
+			}
+
+			if (const Tile* tile = map.canWalkTo(creature, nextPos)) {
+				bestDir = dir;
+				bestTile = tile;
+				bestCost = cost;
+				bestDistance = nextDistance;
+			}
+		}
+
+		// the field does not know about creatures and fields that only hurt some walkers, the A* search weighs
+		// such a step against a detour
+		if (bestDir == DIRECTION_NONE || AStarNodes::getTileWalkCost(creature, bestTile) != 0) {
+			return false;
+		}
+
+		steps.push_back(bestDir);
+		pos = getNextPosition(bestDir, pos);
+		distance = bestDistance;
+	}
+
+	// the end has to be one getPathMatching would accept as well, e.g. in sight of the origin
+	int32_t bestMatchDist = 0;
+	if (!FrozenPathingConditionCall(origin)(startPos, pos, fpp, bestMatchDist)) {
+		return false;
+	}
+
+	// the walk list is consumed from the back
+	dirList.insert(dirList.end(), steps.rbegin(), steps.rend());
+	return true;
+}
@@ -0,0 +1,48 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_FLOWFIELD_H
+#define FS_FLOWFIELD_H
+
+#include "map.h"
+
+/**
+ * Walking distances towards a single creature, shared by everything following it.
+ * The field covers the viewport around the creature and is only computed again
+ * once the creature moved or a tile inside it changed whether it can be walked on.
+ */
+class FlowField
+{
+public:
+	static constexpr int32_t RADIUS = Map::maxViewportX;
+	static constexpr int32_t SIZE = RADIUS * 2 + 1;
+
+	FlowField() = default;
+
+	// non-copyable
+	FlowField(const FlowField&) = delete;
+	FlowField& operator=(const FlowField&) = delete;
+
+	bool isValid(const Map& map, const Position& origin) const;
+
+	void update(const Map& map, const Position& origin);
+
+	/**
+	 * Follows the field downhill from the position of creature until it stands
+	 * next to the origin, skipping tiles the creature itself cannot walk on.
+	 * \returns false if the creature is outside the field, gets stuck, or would
+	 * take a path that getPathMatching with fpp would not, the caller then
+	 * searches the path itself
+	 */
+	bool getPath(const Map& map, const Creature& creature, std::vector<Direction>& dirList,
+	             const FindPathParams& fpp) const;
+
+private:
+	int32_t getDistance(const Position& pos) const;
+
+	std::array<int32_t, SIZE * SIZE> distances;
+	Position origin;
+	uint64_t stamp = 0;
+};
+
+#endif // FS_FLOWFIELD_H
@@ -17,12 +17,14 @@
 #include "items.h"
 #include "monster.h"
 #include "movement.h"
+#include "outputmessage.h"
 #include "scheduler.h"
 #include "script.h"
 #include "server.h"
 #include "spells.h"
 #include "talkaction.h"
 #include "weapons.h"
+#include "workerpool.h"
 
 extern Actions* g_actions;
 extern Chat* g_chat;
@@ -47,21 +49,26 @@ Game::~Game()
 void Game::start(ServiceManager* manager)
 {
 	serviceManager = manager;
-	
-	// Clear the player grid to ensure a clean start
-	map.clearPlayerGrid();
-	
-	// Staggered creature checking (4 chunks) with evenly spaced intervals
-	int32_t interval = EVENT_CREATURE_THINK_INTERVAL / 4;
-	g_scheduler.addEvent(createSchedulerTask(interval * 0, [this]() { checkCreaturesChunk(0); }));
-	g_scheduler.addEvent(createSchedulerTask(interval * 1, [this]() { checkCreaturesChunk(1); }));
-	g_scheduler.addEvent(createSchedulerTask(interval * 2, [this]() { checkCreaturesChunk(2); }));
-	g_scheduler.addEvent(createSchedulerTask(interval * 3, [this]() { checkCreaturesChunk(3); }));
-	
-	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }));
-	
-	// Start network thread for asynchronous packet sending
-	startNetworkThread();
+
+	tickInterval = std::min<int32_t>(getInteger(ConfigManager::GAME_TICK_INTERVAL), EVENT_CREATURE_THINK_INTERVAL);
+	if (tickInterval > 0) {
+		// everything below runs as phases of the tick, input and output included
+		g_dispatcher.setHoldNetworkTasks(true);
+		OutputMessagePool::getInstance().setAutosendTimer(false);
+
+		nextTickTime = std::chrono::steady_clock::now();
+		lastTickTime = OTSYS_TIME();
+		g_scheduler.addEvent(createSchedulerTask(tickInterval, [this]() { gameTick(); }, {TASK_CATEGORY_GAME}));
+	} else {
+		// Staggered creature checking (4 chunks) with evenly spaced intervals
+		int32_t interval = EVENT_CREATURE_THINK_INTERVAL / 4;
+		g_scheduler.addEvent(createSchedulerTask(interval * 0, [this]() { checkCreaturesChunk(0); }));
+		g_scheduler.addEvent(createSchedulerTask(interval * 1, [this]() { checkCreaturesChunk(1); }));
+		g_scheduler.addEvent(createSchedulerTask(interval * 2, [this]() { checkCreaturesChunk(2); }));
+		g_scheduler.addEvent(createSchedulerTask(interval * 3, [this]() { checkCreaturesChunk(3); }));
+
+		g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }, {TASK_CATEGORY_GAME}));
+	}
 }
 
 GameState_t Game::getGameState() const { return gameState; }
@@ -512,12 +519,6 @@ bool Game::placeCreature(Creature* creature, const Position& pos, bool extendedP
 		return false;
 	}
 
-	// Add player to the grid for spatial partitioning
-	if (Player* player = creature->getPlayer()) {
-		auto region = std::make_pair(pos.x / Map::GRID_SIZE, pos.y / Map::GRID_SIZE);
-		map.playerGrid[region].push_back(player);
-	}
-
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true);
 	for (Creature* spectator : spectators) {
@@ -556,14 +557,6 @@ bool Game::removeCreature(Creature* creature, bool isLogout /* = true*/)
 		}
 	}
 
-	// Remove from spatial partitioning grid if it's a player
-	if (Player* player = creature->getPlayer()) {
-		Position pos = tile->getPosition();
-		auto region = std::make_pair(pos.x / Map::GRID_SIZE, pos.y / Map::GRID_SIZE);
-		auto& vec = map.playerGrid[region];
-		vec.erase(std::remove(vec.begin(), vec.end(), player), vec.end());
-	}
-
 	tile->removeCreature(creature);
 
 	const Position& tilePosition = tile->getPosition();
@@ -1312,9 +1305,7 @@ ReturnValue Game::internalMoveItem(Cylinder* fromCylinder, Cylinder* toCylinder,
 
 	if (moveItem && moveItem->getDuration() > 0) {
 		if (moveItem->getDecaying() != DECAYING_TRUE) {
-			moveItem->incrementReferenceCounter();
-			moveItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(moveItem);
+			addDecayItem(moveItem);
 		}
 	}
 
@@ -1417,9 +1408,7 @@ ReturnValue Game::internalAddItem(Cylinder* toCylinder, Item* item, int32_t inde
 	}
 
 	if (item->getDuration() > 0) {
-		item->incrementReferenceCounter();
-		item->setDecaying(DECAYING_TRUE);
-		toDecayItems.push_front(item);
+		addDecayItem(item);
 	}
 
 	return RETURNVALUE_NOERROR;
@@ -1454,10 +1443,7 @@ ReturnValue Game::internalRemoveItem(Item* item, int32_t count /*= -1*/, bool te
 
 		if (item->isRemoved()) {
 			item->onRemoved();
-			if (item->canDecay()) {
-				decayItems->remove(item);
-			}
-			
+
 			// Use object pooling for splashes and fluid containers
 			const ItemType& it = Item::items[item->getID()];
 			if (it.isSplash() || it.isFluidContainer()) {
@@ -1775,9 +1761,7 @@ Item* Game::transformItem(Item* item, uint16_t newId, int32_t newCount /*= -1*/)
 
 	if (newItem->getDuration() > 0) {
 		if (newItem->getDecaying() != DECAYING_TRUE) {
-			newItem->incrementReferenceCounter();
-			newItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(newItem);
+			addDecayItem(newItem);
 		}
 	}
 
@@ -3311,7 +3295,7 @@ void Game::playerSetAttackedCreature(uint32_t playerId, uint32_t creatureId)
 	}
 
 	player->setAttackedCreature(attackCreature);
-	g_dispatcher.addTask([this, id = player->getID()]() { updateCreatureWalk(id); });
+	g_dispatcher.addTask([this, id = player->getID()]() { updateCreatureWalk(id); }, {TASK_CATEGORY_PATHFINDING});
 }
 
 void Game::playerFollowCreature(uint32_t playerId, uint32_t creatureId)
@@ -3322,7 +3306,7 @@ void Game::playerFollowCreature(uint32_t playerId, uint32_t creatureId)
 	}
 
 	player->setAttackedCreature(nullptr);
-	g_dispatcher.addTask([this, id = player->getID()]() { updateCreatureWalk(id); });
+	g_dispatcher.addTask([this, id = player->getID()]() { updateCreatureWalk(id); }, {TASK_CATEGORY_PATHFINDING});
 	player->setFollowCreature(getCreatureByID(creatureId));
 }
 
@@ -3758,11 +3742,15 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, std::strin
 		spectators = (*spectatorsPtr);
 	}
 
-	// send to client
+	// send to client, encoded with the first player that hears it and copied for the others
+	std::optional<NetworkMessage> msg;
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
 			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
+				if (!msg) {
+					ProtocolGame::AddCreatureSay(msg.emplace(), creature, type, text, pos);
+				}
+				tmpPlayer->sendNetworkMessage(*msg);
 			}
 		}
 	}
@@ -3827,10 +3815,28 @@ void Game::removeCreatureCheck(Creature* creature)
 
 void Game::checkCreatures(size_t index)
 {
-	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL,
-	                                         [=, this]() { checkCreatures((index + 1) % EVENT_CREATURECOUNT); }));
+	g_scheduler.addEvent(createSchedulerTask(
+	    EVENT_CHECK_CREATURE_INTERVAL, [=, this]() { checkCreatures((index + 1) % EVENT_CREATURECOUNT); },
+	    {TASK_CATEGORY_GAME}));
+
+	thinkCreatures(index, true);
 
+	// Send batched updates to all players if this is the last index
+	if (index == EVENT_CREATURECOUNT - 1) {
+		for (const auto& [playerId, player] : players) {
+			player->sendPendingUpdates();
+		}
+	}
+
+	cleanup();
+}
+
+void Game::thinkCreatures(size_t index, bool withConditions)
+{
 	auto& checkCreatureList = checkCreatureLists[index];
+	map.trimPathGraph();
+	planFollowPaths(checkCreatureList);
+
 	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
 	while (it != end) {
 		Creature* creature = *it;
@@ -3838,7 +3844,9 @@ void Game::checkCreatures(size_t index)
 			if (!creature->isDead()) {
 				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
 				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
-				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+				if (withConditions) {
+					creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+				}
 			}
 			++it;
 		} else {
@@ -3847,15 +3855,191 @@ void Game::checkCreatures(size_t index)
 			ReleaseCreature(creature);
 		}
 	}
+}
 
-	// Send batched updates to all players if this is the last index
-	if (index == EVENT_CREATURECOUNT - 1) {
-		for (const auto& [playerId, player] : players) {
-			player->sendPendingUpdates();
+void Game::planFollowPaths(const std::list<Creature*>& creatures)
+{
+	if (g_workerPool.getThreadCount() == 0) {
+		return;
+	}
+
+	std::vector<Creature*> planners;
+	std::vector<Creature*> fields;
+	for (Creature* creature : creatures) {
+		if (!creature->creatureCheck || creature->isDead() || !creature->getMonster() ||
+		    !creature->isFollowPathDue(EVENT_CREATURE_THINK_INTERVAL)) {
+			continue;
+		}
+
+		FindPathParams fpp;
+		if (creature->getFollowPathParams(fpp)) {
+			planners.push_back(creature);
+			if (Creature::usesFollowerField(fpp)) {
+				fields.push_back(creature->getFollowCreature());
+			}
 		}
 	}
 
-	cleanup();
+	if (planners.empty()) {
+		return;
+	}
+
+	// nothing changes the map until the workers are done, and each job only writes to its own creature, flow
+	// fields are shared by every follower so they are updated once per followed creature before the searches
+	std::sort(fields.begin(), fields.end());
+	fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
+	g_workerPool.parallelFor(fields.size(), [&fields](size_t i) { fields[i]->updateFollowerField(); });
+	g_workerPool.parallelFor(planners.size(), [&planners](size_t i) { planners[i]->planFollowPath(); });
+}
+
+void Game::executeCreatureConditions(size_t index)
+{
+	for (Creature* creature : checkCreatureLists[index]) {
+		if (creature->creatureCheck && !creature->isDead()) {
+			creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+		}
+	}
+}
+
+uint32_t Game::addWalkEvent(uint32_t delay, uint32_t creatureId)
+{
+	// 0 means no walk event to the creature
+	if (++lastWalkEventId == 0) {
+		++lastWalkEventId;
+	}
+
+	int64_t due = OTSYS_TIME() + delay;
+	walkEvents.emplace(std::make_pair(due, lastWalkEventId), creatureId);
+	walkEventTimes.emplace(lastWalkEventId, due);
+	return lastWalkEventId;
+}
+
+void Game::stopWalkEvent(uint32_t eventId)
+{
+	auto it = walkEventTimes.find(eventId);
+	if (it == walkEventTimes.end()) {
+		return;
+	}
+
+	walkEvents.erase(std::make_pair(it->second, eventId));
+	walkEventTimes.erase(it);
+}
+
+const char* getGameTickPhaseName(GameTickPhase_t phase)
+{
+	switch (phase) {
+		case GAME_TICK_PHASE_NETWORK:
+			return "network";
+		case GAME_TICK_PHASE_THINK:
+			return "think";
+		case GAME_TICK_PHASE_WALK:
+			return "walk";
+		case GAME_TICK_PHASE_CONDITIONS:
+			return "conditions";
+		case GAME_TICK_PHASE_DECAY:
+			return "decay";
+		case GAME_TICK_PHASE_FLUSH:
+			return "flush";
+		default:
+			return "unknown";
+	}
+}
+
+void Game::gameTick()
+{
+	using clock = std::chrono::steady_clock;
+
+	const auto interval = std::chrono::milliseconds(tickInterval);
+	const auto tickStart = clock::now();
+	// once this much of the tick is used up the phases that can wait are put off to a later tick
+	const auto budgetEnd = tickStart + interval * 3 / 4;
+
+	int64_t now = OTSYS_TIME();
+	int32_t elapsed = static_cast<int32_t>(std::min<int64_t>(now - lastTickTime, EVENT_CREATURE_THINK_INTERVAL));
+	lastTickTime = now;
+
+	// a deferred phase gets the missed game time on its next run, up to one full round of its lists
+	thinkTime = std::min(thinkTime + elapsed, EVENT_CREATURE_THINK_INTERVAL);
+	conditionTime = std::min(conditionTime + elapsed, EVENT_CREATURE_THINK_INTERVAL);
+
+	auto runPhase = [&](GameTickPhase_t phase, bool deferrable, auto&& func) {
+		auto& stats = tickStats.phases[phase];
+		auto phaseStart = clock::now();
+		if (deferrable && phaseStart > budgetEnd) {
+			++stats.deferrals;
+			return;
+		}
+
+		func();
+
+		auto duration = clock::now() - phaseStart;
+		stats.total += duration;
+		stats.max = std::max<std::chrono::nanoseconds>(stats.max, duration);
+		++stats.runs;
+	};
+
+	runPhase(GAME_TICK_PHASE_NETWORK, false, []() { g_dispatcher.runNetworkTasks(); });
+
+	runPhase(GAME_TICK_PHASE_THINK, true, [this]() {
+		for (; thinkTime >= EVENT_CHECK_CREATURE_INTERVAL; thinkTime -= EVENT_CHECK_CREATURE_INTERVAL) {
+			thinkCreatures(thinkIndex, false);
+			thinkIndex = (thinkIndex + 1) % EVENT_CREATURECOUNT;
+		}
+	});
+
+	runPhase(GAME_TICK_PHASE_WALK, false, [this]() {
+		const int64_t stepTime = OTSYS_TIME();
+		while (!walkEvents.empty()) {
+			auto it = walkEvents.begin();
+			if (it->first.first > stepTime) {
+				break;
+			}
+
+			uint32_t creatureId = it->second;
+			walkEventTimes.erase(it->first.second);
+			walkEvents.erase(it);
+			checkCreatureWalk(creatureId);
+		}
+	});
+
+	runPhase(GAME_TICK_PHASE_CONDITIONS, true, [this]() {
+		for (; conditionTime >= EVENT_CHECK_CREATURE_INTERVAL; conditionTime -= EVENT_CHECK_CREATURE_INTERVAL) {
+			executeCreatureConditions(conditionIndex);
+			conditionIndex = (conditionIndex + 1) % EVENT_CREATURECOUNT;
+		}
+	});
+
+	// items are decayed by deadline, a deferred run picks up everything that expired in the meantime
+	runPhase(GAME_TICK_PHASE_DECAY, true, [this]() { decayExpiredItems(); });
+
+	runPhase(GAME_TICK_PHASE_FLUSH, false, [this]() {
+		for (const auto& it : players) {
+			it.second->sendPendingUpdates();
+		}
+		OutputMessagePool::getInstance().sendAll();
+		cleanup();
+	});
+
+	auto tickEnd = clock::now();
+	auto duration = tickEnd - tickStart;
+	tickStats.total += duration;
+	tickStats.max = std::max<std::chrono::nanoseconds>(tickStats.max, duration);
+	++tickStats.ticks;
+	if (duration > interval) {
+		++tickStats.overruns;
+	}
+
+	// keep the ticks on a fixed grid, a tick that is a whole interval or more late is dropped instead of run back to
+	// back with the next one
+	nextTickTime += interval;
+	if (tickEnd - nextTickTime >= interval) {
+		auto missed = (tickEnd - nextTickTime) / interval;
+		tickStats.skippedTicks += missed;
+		nextTickTime += interval * missed;
+	}
+
+	auto delay = std::chrono::ceil<std::chrono::milliseconds>(std::max(nextTickTime - tickEnd, clock::duration::zero()));
+	g_scheduler.addEvent(createSchedulerTask(delay.count(), [this]() { gameTick(); }, {TASK_CATEGORY_GAME}));
 }
 
 void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
@@ -4550,9 +4734,16 @@ void Game::addCreatureHealth(const Creature* target)
 
 void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* target)
 {
+	if (spectators.empty()) {
+		return;
+	}
+
+	// the message is the same for every spectator, so it is encoded once and copied into each output buffer
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureHealth(msg, target);
 	for (Creature* spectator : spectators) {
 		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendCreatureHealth(target);
+		static_cast<Player*>(spectator)->sendNetworkMessage(msg);
 	}
 }
 
@@ -4570,9 +4761,15 @@ void Game::addAnimatedText(std::string_view message, const Position& pos, TextCo
 void Game::addAnimatedText(const SpectatorVec& spectators, std::string_view message, const Position& pos,
                            TextColor_t color)
 {
+	if (spectators.empty()) {
+		return;
+	}
+
+	NetworkMessage msg;
+	ProtocolGame::AddAnimatedText(msg, message, pos, color);
 	for (Creature* spectator : spectators) {
 		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendAnimatedText(message, pos, color);
+		static_cast<Player*>(spectator)->sendEffectMessage(msg, &pos);
 	}
 }
 
@@ -4585,9 +4782,15 @@ void Game::addMagicEffect(const Position& pos, uint8_t effect)
 
 void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
 {
+	if (spectators.empty()) {
+		return;
+	}
+
+	NetworkMessage msg;
+	ProtocolGame::AddMagicEffect(msg, pos, effect);
 	for (Creature* spectator : spectators) {
 		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendMagicEffect(pos, effect);
+		static_cast<Player*>(spectator)->sendEffectMessage(msg, &pos);
 	}
 }
 
@@ -4604,9 +4807,15 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos,
                              uint8_t effect)
 {
+	if (spectators.empty()) {
+		return;
+	}
+
+	NetworkMessage msg;
+	ProtocolGame::AddDistanceShoot(msg, fromPos, toPos, effect);
 	for (Creature* spectator : spectators) {
 		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendDistanceShoot(fromPos, toPos, effect);
+		static_cast<Player*>(spectator)->sendEffectMessage(msg);
 	}
 }
 
@@ -4691,14 +4900,24 @@ void Game::startDecay(Item* item)
 	}
 
 	if (item->getDuration() > 0) {
-		item->incrementReferenceCounter();
-		item->setDecaying(DECAYING_TRUE);
-		toDecayItems.push_front(item);
+		addDecayItem(item);
 	} else {
 		internalDecayItem(item);
 	}
 }
 
+void Game::addDecayItem(Item* item)
+{
+	assert(!WorkerPool::isWorkerThread());
+
+	// the wheel holds a reference until the entry comes up
+	int64_t deadline = OTSYS_TIME() + item->getDuration();
+	item->incrementReferenceCounter();
+	item->setDecaying(DECAYING_TRUE);
+	item->setDecayDeadline(deadline);
+	decayItems.add(item, deadline);
+}
+
 void Game::internalDecayItem(Item* item)
 {
 	const int32_t decayTo = item->getDecayTo();
@@ -4715,46 +4934,37 @@ void Game::internalDecayItem(Item* item)
 
 void Game::checkDecay()
 {
-	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }));
+	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }, {TASK_CATEGORY_GAME}));
 
-	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
+	decayExpiredItems();
+}
 
-	auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
-	while (it != end) {
-		Item* item = *it;
-		if (!item->canDecay()) {
-			item->setDecaying(DECAYING_FALSE);
+void Game::decayExpiredItems()
+{
+	std::vector<DecayEntry> expired;
+	decayItems.advance(OTSYS_TIME(), expired);
+
+	for (const DecayEntry& entry : expired) {
+		Item* item = entry.item;
+		if (item->getDecaying() != DECAYING_TRUE || item->getDecayDeadline() != entry.deadline) {
+			// stopped decaying, or got a new deadline that has an entry of its own
 			ReleaseItem(item);
-			it = decayItems[bucket].erase(it);
 			continue;
 		}
 
-		int32_t duration = item->getDuration();
-		int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS, duration);
-
-		duration -= decreaseTime;
-		item->decreaseDuration(decreaseTime);
-
-		if (duration <= 0) {
-			it = decayItems[bucket].erase(it);
-			internalDecayItem(item);
+		if (!item->canDecay()) {
+			item->setDecaying(DECAYING_FALSE);
 			ReleaseItem(item);
-		} else if (duration < EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket =
-			    (bucket + static_cast<size_t>((duration + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAY_BUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				ReleaseItem(item);
-			} else {
-				decayItems[newBucket].push_back(item);
-			}
-		} else {
-			++it;
+			continue;
 		}
+
+		// the duration is used up, the item stays marked as decaying until it is transformed or removed
+		item->setDecayDeadline(0);
+		item->setDuration(0);
+		internalDecayItem(item);
+		ReleaseItem(item);
 	}
 
-	lastBucket = bucket;
 	cleanup();
 }
 
@@ -4765,14 +4975,9 @@ void Game::shutdown()
 	g_scheduler.shutdown();
 	g_databaseTasks.shutdown();
 	g_dispatcher.shutdown();
+	g_workerPool.shutdown();
 	map.spawns.clear();
 	raids.clear();
-	
-	// Clear the player grid
-	map.clearPlayerGrid();
-	
-	// Stop network thread
-	stopNetworkThread();
 
 	cleanup();
 }
@@ -4789,16 +4994,6 @@ void Game::cleanup()
 		item->decrementReferenceCounter();
 	}
 	ToReleaseItems.clear();
-
-	for (Item* item : toDecayItems) {
-		const uint32_t dur = item->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			decayItems[lastBucket].push_back(item);
-		} else {
-			decayItems[(lastBucket + 1 + dur / 1000) % EVENT_DECAY_BUCKETS].push_back(item);
-		}
-	}
-	toDecayItems.clear();
 }
 
 void Game::ReleaseCreature(Creature* creature) { ToReleaseCreatures.push_back(creature); }
@@ -5230,7 +5425,11 @@ BedItem* Game::getBedBySleeper(uint32_t guid) const
 	return it->second;
 }
 
-void Game::setBedSleeper(BedItem* bed, uint32_t guid) { bedSleepersMap[guid] = bed; }
+void Game::setBedSleeper(BedItem* bed, uint32_t guid)
+{
+	assert(!WorkerPool::isWorkerThread());
+	bedSleepersMap[guid] = bed;
+}
 
 void Game::removeBedSleeper(uint32_t guid)
 {
@@ -5251,6 +5450,7 @@ Item* Game::getUniqueItem(uint16_t uniqueId)
 
 bool Game::addUniqueItem(uint16_t uniqueId, Item* item)
 {
+	assert(!WorkerPool::isWorkerThread());
 	auto result = uniqueItems.emplace(uniqueId, item);
 	if (!result.second) {
 		std::cout << "Duplicate unique id: " << uniqueId << std::endl;
@@ -5465,65 +5665,6 @@ void Game::checkCreaturesChunk(size_t chunk)
 	}
 }
 
-void Game::enqueueNetworkUpdate(Player* player, NetworkMessage&& msg)
-{
-    std::lock_guard<std::mutex> lock(networkMutex);
-    size_t maxQueueSize = static_cast<size_t>(ConfigManager::getInteger(ConfigManager::NETWORK_QUEUE_SIZE));
-    
-    // If queue is full, need to drop some non-critical updates
-    if (networkQueue.size() >= maxQueueSize) {
-        // For now, just drop the newest update if queue is full
-        std::cout << "[Warning] Network queue full, dropping update for player " << player->getID() << std::endl;
-        return;
-    }
-    
-    networkQueue.emplace(player, std::move(msg));
-    networkCondition.notify_one();
-}
-
-void Game::networkThread()
-{
-    while (networkThreadRunning) {
-        std::unique_lock<std::mutex> lock(networkMutex);
-        if (networkQueue.empty()) {
-            // Wait for notification or until the thread should stop
-            networkCondition.wait(lock, [this]() { 
-                return !networkQueue.empty() || !networkThreadRunning; 
-            });
-            
-            // If we woke up because the thread should stop, exit the loop
-            if (!networkThreadRunning) break;
-        }
-        
-        // Get the next task and unlock to allow other threads to add to the queue
-        auto task = std::move(networkQueue.front());
-        networkQueue.pop();
-        lock.unlock();
-        
-        // Send the network message
-        task.first->sendNetworkMessage(task.second);
-    }
-}
-
-void Game::startNetworkThread()
-{
-    networkThreadRunning = true;
-    networkSendThread = std::thread(&Game::networkThread, this);
-}
-
-void Game::stopNetworkThread()
-{
-    {
-        std::lock_guard<std::mutex> lock(networkMutex);
-        networkThreadRunning = false;
-        networkCondition.notify_one(); // Wake up the thread if it's waiting
-    }
-    
-    if (networkSendThread.joinable()) {
-        networkSendThread.join();
-    }
-}
-
 Item* Game::getPooledItem(uint16_t id)
 {
     std::lock_guard<std::mutex> lock(itemPoolMutex);
@@ -5550,7 +5691,8 @@ void Game::returnPooledItem(Item* item)
         item->setParent(nullptr);
         itemPool.push_back(item);
     } else {
-        delete item;
+        // the decay wheel may still hold a reference
+        ReleaseItem(item);
     }
 }
 
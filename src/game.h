@@ -4,15 +4,12 @@
 #ifndef FS_GAME_H
 #define FS_GAME_H
 
-#include <atomic>
 #include <mutex>
-#include <queue>
-#include <thread>
-#include <condition_variable>
 
 #include "account.h"
 #include "combat.h"
 #include "container.h"
+#include "decay.h"
 #include "groups.h"
 #include "item.h"
 #include "map.h"
@@ -70,8 +67,7 @@ inline constexpr int32_t PLAYER_NAME_LENGTH = 25;
 
 inline constexpr int32_t EVENT_LIGHTINTERVAL = 10000;
 inline constexpr int32_t EVENT_WORLDTIMEINTERVAL = 2500;
-inline constexpr int32_t EVENT_DECAYINTERVAL = 250;
-inline constexpr int32_t EVENT_DECAY_BUCKETS = 4;
+inline constexpr int32_t EVENT_DECAYINTERVAL = DecayWheel::TICK_LENGTH;
 
 inline constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 inline constexpr int32_t RANGE_MOVE_CREATURE_INTERVAL = 1500;
@@ -84,6 +80,41 @@ inline constexpr int32_t RANGE_BROWSE_FIELD_INTERVAL = 400;
 inline constexpr int32_t RANGE_WRAP_ITEM_INTERVAL = 400;
 inline constexpr int32_t RANGE_REQUEST_TRADE_INTERVAL = 400;
 
+enum GameTickPhase_t : uint8_t
+{
+	GAME_TICK_PHASE_NETWORK,
+	GAME_TICK_PHASE_THINK,
+	GAME_TICK_PHASE_WALK,
+	GAME_TICK_PHASE_CONDITIONS,
+	GAME_TICK_PHASE_DECAY,
+	GAME_TICK_PHASE_FLUSH,
+
+	GAME_TICK_PHASE_LAST = GAME_TICK_PHASE_FLUSH,
+};
+
+struct GameTickPhaseStats
+{
+	std::chrono::nanoseconds total{0};
+	std::chrono::nanoseconds max{0};
+	uint64_t runs = 0;
+	// ticks in which the phase was put off because the tick ran over its budget
+	uint64_t deferrals = 0;
+};
+
+struct GameTickStats
+{
+	std::array<GameTickPhaseStats, GAME_TICK_PHASE_LAST + 1> phases;
+	std::chrono::nanoseconds total{0};
+	std::chrono::nanoseconds max{0};
+	uint64_t ticks = 0;
+	// ticks that took longer than the tick interval
+	uint64_t overruns = 0;
+	// ticks that never ran because the loop fell a whole interval or more behind
+	uint64_t skippedTicks = 0;
+};
+
+const char* getGameTickPhaseName(GameTickPhase_t phase);
+
 /**
  * Main Game class.
  * This class is responsible to control everything that happens
@@ -430,6 +461,14 @@ public:
 	void checkCreatures(size_t index);
 	void checkCreaturesChunk(size_t chunk); // For staggered processing
 
+	// fixed tick game loop, enabled by gameTickInterval in config.lua
+	bool hasFixedTick() const { return tickInterval > 0; }
+	const GameTickStats& getTickStats() const { return tickStats; }
+
+	// in fixed tick mode creature walks are stepped by the walk phase instead of scheduler events
+	uint32_t addWalkEvent(uint32_t delay, uint32_t creatureId);
+	void stopWalkEvent(uint32_t eventId);
+
 	bool combatBlockHit(CombatDamage& damage, Creature* attacker, Creature* target, bool checkDefense, bool checkArmor,
 	                    bool field, bool ignoreResistances = false);
 
@@ -456,6 +495,8 @@ public:
 	bool saveAccountStorageValues() const;
 
 	void startDecay(Item* item);
+	// puts an item with a duration left into the decay wheel
+	void addDecayItem(Item* item);
 
 	void loadMotdNum();
 	void saveMotdNum() const;
@@ -496,8 +537,6 @@ public:
 	Raids raids;
 	Mounts mounts;
 
-	std::forward_list<Item*> toDecayItems;
-
 	std::unordered_set<Tile*> getTilesToClean() const { return tilesToClean; }
 	void addTileToClean(Tile* tile) { tilesToClean.emplace(tile); }
 	void removeTileToClean(Tile* tile) { tilesToClean.erase(tile); }
@@ -514,26 +553,12 @@ public:
 	void returnPooledItem(Item* item);
 	Item* createItem(uint16_t itemId, uint16_t count = 0);
 
-	// Thread-related methods
-	void startNetworkThread();
-	void stopNetworkThread();
-	void enqueueNetworkUpdate(Player* player, NetworkMessage&& msg);
-
 	void updatePlayerHelpers(Player& player);
 
 protected:
-	// Thread-safe network update queue
-	std::queue<std::pair<Player*, NetworkMessage>> networkQueue;
-	std::mutex networkMutex;
-	std::condition_variable networkCondition;
-	std::atomic<bool> networkThreadRunning{false};
-	std::thread networkSendThread;
-	
 	// Object pooling for memory management
 	std::vector<Item*> itemPool;
 	std::mutex itemPoolMutex;
-	
-	void networkThread();
 
 private:
 	std::unordered_map<uint32_t, int64_t> storageMap;
@@ -545,8 +570,14 @@ private:
 	void playerSpeakToNpc(Player* player, std::string_view text);
 
 	void checkDecay();
+	void decayExpiredItems();
 	void internalDecayItem(Item* item);
 
+	void gameTick();
+	void thinkCreatures(size_t index, bool withConditions);
+	void planFollowPaths(const std::list<Creature*>& creatures);
+	void executeCreatureConditions(size_t index);
+
 	std::unordered_map<uint32_t, Player*> players;
 	std::unordered_map<std::string, Player*> mappedPlayerNames;
 	std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
@@ -555,13 +586,26 @@ private:
 	std::unordered_map<uint32_t, uint32_t> stages;
 	std::unordered_map<uint32_t, std::unordered_map<uint32_t, int32_t>> accountStorageMap;
 
-	std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
+	DecayWheel decayItems;
 	std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
 
 	std::vector<Creature*> ToReleaseCreatures;
 	std::vector<Item*> ToReleaseItems;
 
-	size_t lastBucket = 0;
+	GameTickStats tickStats;
+	std::chrono::steady_clock::time_point nextTickTime;
+	int64_t lastTickTime = 0;
+	int32_t tickInterval = 0;
+	// game time the deferrable phases still have to make up, and the creature list each of them continues with
+	int32_t thinkTime = 0;
+	int32_t conditionTime = 0;
+	size_t thinkIndex = 0;
+	size_t conditionIndex = 0;
+
+	// (due time, walk event id) -> creature id, and walk event id -> due time
+	std::map<std::pair<int64_t, uint32_t>, uint32_t> walkEvents;
+	std::unordered_map<uint32_t, int64_t> walkEventTimes;
+	uint32_t lastWalkEventId = 0;
 
 	WildcardTreeNode wildcardTree{false};
 
@@ -53,7 +53,8 @@ bool GlobalEvents::registerEvent(Event_ptr event, const pugi::xml_node&)
 		auto result = timerMap.emplace(globalEvent->getName(), std::move(*globalEvent));
 		if (result.second) {
 			if (timerEventId == 0) {
-				timerEventId = g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [this]() { timer(); }));
+				timerEventId = g_scheduler.addEvent(
+				    createSchedulerTask(SCHEDULER_MINTICKS, [this]() { timer(); }, {TASK_CATEGORY_LUA}));
 			}
 			return true;
 		}
@@ -66,7 +67,8 @@ bool GlobalEvents::registerEvent(Event_ptr event, const pugi::xml_node&)
 		auto result = thinkMap.emplace(globalEvent->getName(), std::move(*globalEvent));
 		if (result.second) {
 			if (thinkEventId == 0) {
-				thinkEventId = g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [this]() { think(); }));
+				thinkEventId = g_scheduler.addEvent(
+				    createSchedulerTask(SCHEDULER_MINTICKS, [this]() { think(); }, {TASK_CATEGORY_LUA}));
 			}
 			return true;
 		}
@@ -84,7 +86,8 @@ bool GlobalEvents::registerLuaEvent(GlobalEvent* event)
 		auto result = timerMap.emplace(globalEvent->getName(), std::move(*globalEvent));
 		if (result.second) {
 			if (timerEventId == 0) {
-				timerEventId = g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [this]() { timer(); }));
+				timerEventId = g_scheduler.addEvent(
+				    createSchedulerTask(SCHEDULER_MINTICKS, [this]() { timer(); }, {TASK_CATEGORY_LUA}));
 			}
 			return true;
 		}
@@ -97,7 +100,8 @@ bool GlobalEvents::registerLuaEvent(GlobalEvent* event)
 		auto result = thinkMap.emplace(globalEvent->getName(), std::move(*globalEvent));
 		if (result.second) {
 			if (thinkEventId == 0) {
-				thinkEventId = g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [this]() { think(); }));
+				thinkEventId = g_scheduler.addEvent(
+				    createSchedulerTask(SCHEDULER_MINTICKS, [this]() { think(); }, {TASK_CATEGORY_LUA}));
 			}
 			return true;
 		}
@@ -146,7 +150,8 @@ void GlobalEvents::timer()
 	}
 
 	if (nextScheduledTime != std::numeric_limits<int64_t>::max()) {
-		thinkEventId = g_scheduler.addEvent(createSchedulerTask(nextScheduledTime, [this]() { timer(); }));
+		thinkEventId =
+		    g_scheduler.addEvent(createSchedulerTask(nextScheduledTime, [this]() { timer(); }, {TASK_CATEGORY_LUA}));
 	}
 }
 
@@ -181,7 +186,7 @@ void GlobalEvents::think()
 
 	if (nextScheduledTime != std::numeric_limits<int64_t>::max()) {
 		timerEventId = g_scheduler.addEvent(
-		    createSchedulerTask(std::max<int64_t>(1000, nextScheduledTime), [this]() { think(); }));
+		    createSchedulerTask(std::max<int64_t>(1000, nextScheduledTime), [this]() { think(); }, {TASK_CATEGORY_LUA}));
 	}
 }
 
@@ -6,6 +6,7 @@
 #include "iomap.h"
 
 #include "bed.h"
+#include "workerpool.h"
 
 /*
     OTBM_ROOTV1
@@ -109,40 +110,65 @@ bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName)
 		map->width = root_header.width;
 		map->height = root_header.height;
 
-		if (root.children.size() != 1 || root.children[0].type != OTBM_MAP_DATA) {
+		if (root.children().size() != 1 || root.children().begin()->type != OTBM_MAP_DATA) {
 			setLastErrorString("Could not read data node.");
 			return false;
 		}
 
-		auto& mapNode = root.children[0];
+		auto& mapNode = *root.children().begin();
 		if (!parseMapDataAttributes(loader, mapNode, *map, fileName)) {
 			return false;
 		}
 
-		for (auto& mapDataNode : mapNode.children) {
+		int64_t treeEnd = OTSYS_TIME();
+
+		// tile areas are independent of each other and make up nearly all of the file, so they are read on all
+		// cores first; placing them on the map afterwards keeps the order of the file
+		std::vector<const OTB::Node*> tileAreaNodes;
+		for (auto& mapDataNode : mapNode.children()) {
 			if (mapDataNode.type == OTBM_TILE_AREA) {
-				if (!parseTileArea(loader, mapDataNode, *map)) {
-					return false;
-				}
+				tileAreaNodes.push_back(&mapDataNode);
+			}
+		}
+
+		std::vector<LoadedTileArea> tileAreas;
+		size_t threadCount = parseTileAreas(loader, tileAreaNodes, tileAreas);
+
+		int64_t parseEnd = OTSYS_TIME();
+		int64_t placeTime = 0;
+
+		auto tileArea = tileAreas.begin();
+		bool loaded = true;
+		for (auto& mapDataNode : mapNode.children()) {
+			if (mapDataNode.type == OTBM_TILE_AREA) {
+				int64_t placeStart = OTSYS_TIME();
+				loaded = placeTileArea(*tileArea++, *map);
+				placeTime += OTSYS_TIME() - placeStart;
 			} else if (mapDataNode.type == OTBM_TOWNS) {
-				if (!parseTowns(loader, mapDataNode, *map)) {
-					return false;
-				}
+				loaded = parseTowns(loader, mapDataNode, *map);
 			} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
-				if (!parseWaypoints(loader, mapDataNode, *map)) {
-					return false;
-				}
+				loaded = parseWaypoints(loader, mapDataNode, *map);
 			} else {
 				setLastErrorString("Unknown map node.");
+				loaded = false;
+			}
+
+			if (!loaded) {
+				std::for_each(tileArea, tileAreas.end(), releaseTileArea);
 				return false;
 			}
 		}
+
+		int64_t end = OTSYS_TIME();
+		std::cout << "> Map loading time: " << (end - start) / (1000.) << " seconds." << std::endl;
+		std::cout << ">> Reading nodes: " << (treeEnd - start) / (1000.) << " s, tile areas: "
+		          << (parseEnd - treeEnd) / (1000.) << " s on " << threadCount
+		          << " threads, placing tiles: " << placeTime / (1000.)
+		          << " s, towns and waypoints: " << (end - parseEnd - placeTime) / (1000.) << " s." << std::endl;
 	} catch (const OTB::InvalidOTBFormat& err) {
 		setLastErrorString(err.what());
 		return false;
 	}
-
-	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	return true;
 }
 
@@ -197,67 +223,75 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 	return true;
 }
 
-bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map)
+size_t IOMap::parseTileAreas(OTB::Loader& loader, const std::vector<const OTB::Node*>& tileAreaNodes,
+                             std::vector<LoadedTileArea>& tileAreas)
+{
+	tileAreas.resize(tileAreaNodes.size());
+
+	// nodes differ a lot in size, so every thread takes the next unread node until none are left
+	g_workerPool.parallelFor(tileAreaNodes.size(), [&](size_t i) {
+		Item::deferRegistration = true;
+		if (!parseTileArea(loader, *tileAreaNodes[i], tileAreas[i])) {
+			releaseTileArea(tileAreas[i]);
+		}
+		Item::deferRegistration = false;
+	});
+	return std::min(g_workerPool.getThreadCount() + 1, std::max<size_t>(tileAreaNodes.size(), 1));
+}
+
+bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, LoadedTileArea& tileArea)
 {
 	PropStream propStream;
 	if (!loader.getProps(tileAreaNode, propStream)) {
-		setLastErrorString("Invalid map node.");
+		tileArea.error = "Invalid map node.";
 		return false;
 	}
 
 	OTBM_Destination_coords area_coord;
 	if (!propStream.read(area_coord)) {
-		setLastErrorString("Invalid map node.");
+		tileArea.error = "Invalid map node.";
 		return false;
 	}
 
 	uint16_t base_x = area_coord.x;
 	uint16_t base_y = area_coord.y;
 	uint16_t z = area_coord.z;
+	tileArea.z = area_coord.z;
+	tileArea.tiles.reserve(tileAreaNode.children().size());
 
-	for (auto& tileNode : tileAreaNode.children) {
+	for (auto& tileNode : tileAreaNode.children()) {
 		if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE) {
-			setLastErrorString("Unknown tile node.");
+			tileArea.error = "Unknown tile node.";
 			return false;
 		}
 
 		if (!loader.getProps(tileNode, propStream)) {
-			setLastErrorString("Could not read node data.");
+			tileArea.error = "Could not read node data.";
 			return false;
 		}
 
 		OTBM_Tile_coords tile_coord;
 		if (!propStream.read(tile_coord)) {
-			setLastErrorString("Could not read tile position.");
+			tileArea.error = "Could not read tile position.";
 			return false;
 		}
 
 		uint16_t x = base_x + tile_coord.x;
 		uint16_t y = base_y + tile_coord.y;
 
-		bool isHouseTile = false;
-		House* house = nullptr;
-		Tile* tile = nullptr;
-		Item* ground_item = nullptr;
-		uint32_t tileflags = TILESTATE_NONE;
+		// added right away so that an error further down still finds the items of this tile
+		LoadedTile& tile = tileArea.tiles.emplace_back();
+		tile.x = x;
+		tile.y = y;
+		tile.firstItem = tileArea.items.size();
 
 		if (tileNode.type == OTBM_HOUSETILE) {
-			uint32_t houseId;
-			if (!propStream.read<uint32_t>(houseId)) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z));
-				return false;
-			}
-
-			house = map.houses.addHouse(houseId);
-			if (!house) {
-				setLastErrorString(
-				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
+			if (!propStream.read<uint32_t>(tile.houseId)) {
+				tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z);
 				return false;
 			}
 
-			tile = new HouseTile(x, y, z, house);
-			house->addTile(static_cast<HouseTile*>(tile));
-			isHouseTile = true;
+			tile.isHouseTile = true;
 		}
 
 		uint8_t attribute;
@@ -267,20 +301,20 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				case OTBM_ATTR_TILE_FLAGS: {
 					uint32_t flags;
 					if (!propStream.read<uint32_t>(flags)) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z));
+						tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z);
 						return false;
 					}
 
 					if ((flags & OTBM_TILEFLAG_PROTECTIONZONE) != 0) {
-						tileflags |= TILESTATE_PROTECTIONZONE;
+						tile.flags |= TILESTATE_PROTECTIONZONE;
 					} else if ((flags & OTBM_TILEFLAG_NOPVPZONE) != 0) {
-						tileflags |= TILESTATE_NOPVPZONE;
+						tile.flags |= TILESTATE_NOPVPZONE;
 					} else if ((flags & OTBM_TILEFLAG_PVPZONE) != 0) {
-						tileflags |= TILESTATE_PVPZONE;
+						tile.flags |= TILESTATE_PVPZONE;
 					}
 
 					if ((flags & OTBM_TILEFLAG_NOLOGOUT) != 0) {
-						tileflags |= TILESTATE_NOLOGOUT;
+						tile.flags |= TILESTATE_NOLOGOUT;
 					}
 					break;
 				}
@@ -288,108 +322,148 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				case OTBM_ATTR_ITEM: {
 					Item* item = Item::CreateItem(propStream);
 					if (!item) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
+						tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z);
 						return false;
 					}
 
-					if (isHouseTile && item->isMoveable()) {
-						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID()
-						          << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y
-						          << ", z: " << z << "]." << std::endl;
-						delete item;
-					} else {
-						if (item->getItemCount() == 0) {
-							item->setItemCount(1);
-						}
-
-						if (tile) {
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						} else if (item->isGroundTile()) {
-							delete ground_item;
-							ground_item = item;
-						} else {
-							tile = createTile(ground_item, item, x, y, z);
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
-					}
+					addLoadedItem(tileArea, tile, z, item);
 					break;
 				}
 
 				default:
-					setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z));
+					tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z);
 					return false;
 			}
 		}
 
-		for (auto& itemNode : tileNode.children) {
+		for (auto& itemNode : tileNode.children()) {
 			if (itemNode.type != OTBM_ITEM) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z));
+				tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z);
 				return false;
 			}
 
 			PropStream stream;
 			if (!loader.getProps(itemNode, stream)) {
-				setLastErrorString("Invalid item node.");
+				tileArea.error = "Invalid item node.";
 				return false;
 			}
 
 			Item* item = Item::CreateItem(stream);
 			if (!item) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
+				tileArea.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z);
 				return false;
 			}
 
 			if (!item->unserializeItemNode(loader, itemNode, stream)) {
-				setLastErrorString(
-				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID()));
+				tileArea.error =
+				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID());
 				delete item;
 				return false;
 			}
 
-			if (isHouseTile && item->isMoveable()) {
-				std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID()
-				          << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y
-				          << ", z: " << z << "]." << std::endl;
-				delete item;
-			} else {
-				if (item->getItemCount() == 0) {
-					item->setItemCount(1);
-				}
+			addLoadedItem(tileArea, tile, z, item);
+		}
+	}
+	return true;
+}
 
-				if (tile) {
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				} else if (item->isGroundTile()) {
-					delete ground_item;
-					ground_item = item;
-				} else {
-					tile = createTile(ground_item, item, x, y, z);
-					tile->internalAddThing(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				}
+void IOMap::addLoadedItem(LoadedTileArea& tileArea, LoadedTile& tile, uint8_t z, Item* item)
+{
+	if (tile.isHouseTile && item->isMoveable()) {
+		tileArea.warnings.push_back(
+		    fmt::format("[Warning - IOMap::loadMap] Moveable item with ID: {:d}, in house: {:d}, at position [x: {:d}, "
+		                "y: {:d}, z: {:d}].",
+		                item->getID(), tile.houseId, tile.x, tile.y, z));
+		delete item;
+		return;
+	}
+
+	if (item->getItemCount() == 0) {
+		item->setItemCount(1);
+	}
+
+	// ground items are kept aside until the first other item decides which kind of tile to create
+	if (!tile.isHouseTile && tile.itemCount == 0 && item->isGroundTile()) {
+		delete tile.ground;
+		tile.ground = item;
+	} else {
+		tileArea.items.push_back(item);
+		++tile.itemCount;
+	}
+}
+
+void IOMap::releaseTileArea(LoadedTileArea& tileArea)
+{
+	for (LoadedTile& tile : tileArea.tiles) {
+		delete tile.ground;
+	}
+	tileArea.tiles.clear();
+
+	for (Item* item : tileArea.items) {
+		delete item;
+	}
+	tileArea.items.clear();
+}
+
+bool IOMap::placeTileArea(LoadedTileArea& tileArea, Map& map)
+{
+	for (const std::string& warning : tileArea.warnings) {
+		std::cout << warning << std::endl;
+	}
+
+	uint8_t z = tileArea.z;
+	for (LoadedTile& loadedTile : tileArea.tiles) {
+		uint16_t x = loadedTile.x;
+		uint16_t y = loadedTile.y;
+		Item** items = tileArea.items.data() + loadedTile.firstItem;
+
+		Tile* tile;
+		if (loadedTile.isHouseTile) {
+			House* house = map.houses.addHouse(loadedTile.houseId);
+			if (!house) {
+				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z,
+				                               loadedTile.houseId));
+
+				// the tiles before this one are on the map already
+				const size_t placed = &loadedTile - tileArea.tiles.data();
+				tileArea.items.erase(tileArea.items.begin(), tileArea.items.begin() + loadedTile.firstItem);
+				tileArea.tiles.erase(tileArea.tiles.begin(), tileArea.tiles.begin() + placed);
+				releaseTileArea(tileArea);
+				return false;
+			}
+
+			tile = new HouseTile(x, y, z, house);
+			house->addTile(static_cast<HouseTile*>(tile));
+		} else {
+			if (loadedTile.ground) {
+				loadedTile.ground->registerLoadedAttributes();
 			}
+			tile = createTile(loadedTile.ground, loadedTile.itemCount != 0 ? items[0] : nullptr, x, y, z);
 		}
 
-		if (!tile) {
-			tile = createTile(ground_item, nullptr, x, y, z);
+		for (uint32_t i = 0; i < loadedTile.itemCount; ++i) {
+			Item* item = items[i];
+			item->registerLoadedAttributes();
+			tile->internalAddThing(item);
+			item->startDecaying();
+			item->setLoadedFromMap(true);
 		}
 
-		tile->setFlag(static_cast<tileflags_t>(tileflags));
+		tile->setFlag(static_cast<tileflags_t>(loadedTile.flags));
 
 		map.setTile(x, y, z, tile);
 	}
+
+	if (!tileArea.error.empty()) {
+		setLastErrorString(tileArea.error);
+		return false;
+	}
 	return true;
 }
 
 bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map)
 {
-	for (auto& townNode : townsNode.children) {
+	for (auto& townNode : townsNode.children()) {
 		PropStream propStream;
 		if (townNode.type != OTBM_TOWN) {
 			setLastErrorString("Unknown town node.");
@@ -435,7 +509,7 @@ bool IOMap::parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map
 bool IOMap::parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map)
 {
 	PropStream propStream;
-	for (auto& node : waypointsNode.children) {
+	for (auto& node : waypointsNode.children()) {
 		if (node.type != OTBM_WAYPOINT) {
 			setLastErrorString("Unknown waypoint node.");
 			return false;
@@ -134,11 +134,42 @@ public:
 	void setLastErrorString(std::string_view error) { errorString = error; }
 
 private:
+	// A tile read from a tile area node, not yet placed on the map.
+	struct LoadedTile
+	{
+		Item* ground = nullptr;
+		// items of the tile are LoadedTileArea::items[firstItem, firstItem + itemCount)
+		uint32_t firstItem = 0;
+		uint32_t itemCount = 0;
+		uint32_t houseId = 0;
+		uint32_t flags = TILESTATE_NONE;
+		uint16_t x = 0;
+		uint16_t y = 0;
+		bool isHouseTile = false;
+	};
+
+	// The result of deserializing one tile area node on a worker thread.
+	struct LoadedTileArea
+	{
+		std::vector<LoadedTile> tiles;
+		std::vector<Item*> items;
+		std::vector<std::string> warnings;
+		// set if the node is invalid, the area is released then and holds no tiles
+		std::string error;
+		uint8_t z = 0;
+	};
+
 	bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map,
 	                            const std::filesystem::path& fileName);
 	bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map);
 	bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map);
-	bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map);
+	static size_t parseTileAreas(OTB::Loader& loader, const std::vector<const OTB::Node*>& tileAreaNodes,
+	                             std::vector<LoadedTileArea>& tileAreas);
+	static bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, LoadedTileArea& tileArea);
+	static void addLoadedItem(LoadedTileArea& tileArea, LoadedTile& tile, uint8_t z, Item* item);
+	// deletes the items of an area that was not placed on the map
+	static void releaseTileArea(LoadedTileArea& tileArea);
+	bool placeTileArea(LoadedTileArea& tileArea, Map& map);
 	std::string errorString;
 };
 
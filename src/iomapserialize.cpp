@@ -7,6 +7,7 @@
 
 #include "bed.h"
 #include "game.h"
+#include "workerpool.h"
 
 extern Game g_game;
 
@@ -65,20 +66,32 @@ bool IOMapSerialize::saveHouseItems()
 
 	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
 
-	PropWriteStream stream;
+	std::vector<House*> houses;
+	houses.reserve(g_game.map.houses.getHouses().size());
 	for (const auto& it : g_game.map.houses.getHouses()) {
-		// save house items
-		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
+		houses.push_back(it.second);
+	}
+
+	// the items are serialized on the worker pool while the game waits, the rows are added in order afterwards
+	std::vector<std::vector<std::string>> houseTiles(houses.size());
+	g_workerPool.parallelFor(houses.size(), [&](size_t i) {
+		PropWriteStream stream;
+		for (HouseTile* tile : houses[i]->getTiles()) {
 			saveTile(stream, tile);
 
 			if (auto attributes = stream.getStream(); !attributes.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeString(attributes)))) {
-					return false;
-				}
+				houseTiles[i].emplace_back(attributes);
 				stream.clear();
 			}
 		}
+	});
+
+	for (size_t i = 0; i < houses.size(); ++i) {
+		for (const std::string& attributes : houseTiles[i]) {
+			if (!stmt.addRow(fmt::format("{:d}, {:s}", houses[i]->getId(), db.escapeString(attributes)))) {
+				return false;
+			}
+		}
 	}
 
 	if (!stmt.execute()) {
@@ -20,6 +20,7 @@ extern Spells* g_spells;
 extern Vocations g_vocations;
 
 Items Item::items;
+thread_local bool Item::deferRegistration = false;
 
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 {
@@ -153,7 +154,18 @@ Item::Item(const uint16_t type, uint16_t count /*= 0*/) : id(type)
 Item::Item(const Item& i) : Thing(), id(i.id), count(i.count), loadedFromMap(i.loadedFromMap)
 {
 	if (i.attributes) {
-		attributes.reset(new ItemAttributes(*i.attributes));
+		copyAttributes(i);
+	}
+}
+
+void Item::copyAttributes(const Item& other)
+{
+	attributes.reset(new ItemAttributes(*other.attributes));
+	if (attributes->decayDeadline != 0) {
+		// the deadline and its wheel entry belong to the original, the copy starts out with the time left
+		attributes->setIntAttr(ITEM_ATTRIBUTE_DURATION, other.getDuration());
+		attributes->setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, DECAYING_FALSE);
+		attributes->decayDeadline = 0;
 	}
 }
 
@@ -161,11 +173,9 @@ Item* Item::clone() const
 {
 	Item* item = Item::CreateItem(id, count);
 	if (attributes) {
-		item->attributes.reset(new ItemAttributes(*attributes));
+		item->copyAttributes(*this);
 		if (item->getDuration() > 0) {
-			item->incrementReferenceCounter();
-			item->setDecaying(DECAYING_TRUE);
-			g_game.toDecayItems.push_front(item);
+			g_game.addDecayItem(item);
 		}
 	}
 	return item;
@@ -250,6 +260,9 @@ void Item::setID(uint16_t newid)
 	if (newDuration > 0 && (!prevIt.stopTime || !hasAttribute(ITEM_ATTRIBUTE_DURATION))) {
 		setDecaying(DECAYING_FALSE);
 		setDuration(newDuration);
+	} else if (getDecayDeadline() != 0 && !canDecay()) {
+		// keep the time left now rather than when the wheel entry comes up
+		setDecaying(DECAYING_FALSE);
 	}
 }
 
@@ -788,7 +801,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 
 	if (hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
 		propWriteStream.write<uint8_t>(ATTR_DURATION);
-		propWriteStream.write<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION));
+		propWriteStream.write<uint32_t>(getDuration());
 	}
 
 	ItemDecayState_t decayState = getDecaying();
@@ -1005,11 +1018,26 @@ void Item::setUniqueId(uint16_t n)
 		return;
 	}
 
-	if (g_game.addUniqueItem(n, this)) {
+	if (deferRegistration || g_game.addUniqueItem(n, this)) {
 		getAttributes()->setUniqueId(n);
 	}
 }
 
+void Item::registerLoadedAttributes()
+{
+	if (hasAttribute(ITEM_ATTRIBUTE_UNIQUEID) && !g_game.addUniqueItem(getUniqueId(), this)) {
+		removeAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+	}
+
+	if (BedItem* bed = getBed()) {
+		bed->registerSleeper();
+	} else if (Container* container = getContainer()) {
+		for (Item* item : container->getItemList()) {
+			item->registerLoadedAttributes();
+		}
+	}
+}
+
 void Item::setDefaultDuration()
 {
 	uint32_t duration = getDefaultDurationMin();
@@ -1022,6 +1050,56 @@ void Item::setDefaultDuration()
 	}
 }
 
+void Item::setDuration(int32_t time)
+{
+	setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
+	if (attributes->decayDeadline != 0) {
+		// the wheel entry of the old deadline is dropped once it comes up
+		attributes->decayDeadline = 0;
+		g_game.addDecayItem(this);
+	}
+}
+
+uint32_t Item::getDuration() const
+{
+	if (!attributes) {
+		return 0;
+	}
+
+	if (attributes->decayDeadline != 0) {
+		return static_cast<uint32_t>(std::max<int64_t>(0, attributes->decayDeadline - OTSYS_TIME()));
+	}
+	return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+}
+
+void Item::setDecaying(ItemDecayState_t decayState)
+{
+	if (decayState != DECAYING_TRUE && attributes && attributes->decayDeadline != 0) {
+		// keep what is left of the duration for when the item starts decaying again
+		setIntAttr(ITEM_ATTRIBUTE_DURATION, getDuration());
+		attributes->decayDeadline = 0;
+	}
+	setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState);
+}
+
+void Item::removeAttribute(itemAttrTypes type)
+{
+	if (!attributes) {
+		return;
+	}
+
+	if (attributes->decayDeadline != 0) {
+		if (type == ITEM_ATTRIBUTE_DURATION) {
+			// no time left, the item decays with the next pass of the wheel
+			setDuration(0);
+		} else if (type == ITEM_ATTRIBUTE_DECAYSTATE) {
+			// keep what is left of the duration for when the item starts decaying again
+			setDecaying(DECAYING_FALSE);
+		}
+	}
+	attributes->removeAttribute(type);
+}
+
 bool Item::canDecay() const
 {
 	if (isRemoved()) {
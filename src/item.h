@@ -351,6 +351,9 @@ private:
 	std::vector<Attribute> attributes;
 	uint32_t attributeBits = 0;
 
+	// OTSYS_TIME the duration runs out at, 0 unless the item is decaying
+	int64_t decayDeadline = 0;
+
 	std::map<CombatType_t, Reflect> reflect;
 	std::map<CombatType_t, uint16_t> boostPercent;
 
@@ -485,6 +488,10 @@ public:
 	static Item* CreateItem(PropStream& propStream);
 	static Items items;
 
+	// While set on the calling thread, unique ids and bed sleepers read from attributes are only stored on the item
+	// until registerLoadedAttributes is called, so that map areas can be deserialized on worker threads.
+	static thread_local bool deferRegistration;
+
 	// Constructor for items
 	Item(const uint16_t type, uint16_t count = 0);
 	Item(const Item& i);
@@ -531,12 +538,7 @@ public:
 	void setIntAttr(itemAttrTypes type, int64_t value) { getAttributes()->setIntAttr(type, value); }
 	void increaseIntAttr(itemAttrTypes type, int64_t value) { getAttributes()->increaseIntAttr(type, value); }
 
-	void removeAttribute(itemAttrTypes type)
-	{
-		if (attributes) {
-			attributes->removeAttribute(type);
-		}
-	}
+	void removeAttribute(itemAttrTypes type);
 	bool hasAttribute(itemAttrTypes type) const
 	{
 		if (!attributes) {
@@ -663,23 +665,26 @@ public:
 		return getIntAttr(ITEM_ATTRIBUTE_CORPSEOWNER);
 	}
 
-	void setDuration(int32_t time) { setIntAttr(ITEM_ATTRIBUTE_DURATION, time); }
-	void decreaseDuration(int32_t time) { increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time); }
-	uint32_t getDuration() const
+	// while the item decays the duration left is worked out from its deadline
+	void setDuration(int32_t time);
+	uint32_t getDuration() const;
+
+	void setDecaying(ItemDecayState_t decayState);
+	ItemDecayState_t getDecaying() const
 	{
 		if (!attributes) {
-			return 0;
+			return DECAYING_FALSE;
 		}
-		return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+		return static_cast<ItemDecayState_t>(getIntAttr(ITEM_ATTRIBUTE_DECAYSTATE));
 	}
 
-	void setDecaying(ItemDecayState_t decayState) { setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState); }
-	ItemDecayState_t getDecaying() const
+	void setDecayDeadline(int64_t deadline) { getAttributes()->decayDeadline = deadline; }
+	int64_t getDecayDeadline() const
 	{
 		if (!attributes) {
-			return DECAYING_FALSE;
+			return 0;
 		}
-		return static_cast<ItemDecayState_t>(getIntAttr(ITEM_ATTRIBUTE_DECAYSTATE));
+		return attributes->decayDeadline;
 	}
 
 	int32_t getDecayTimeMin() const
@@ -876,6 +881,8 @@ public:
 	void setSubType(uint16_t n);
 
 	void setUniqueId(uint16_t n);
+	// Registers the unique ids and bed sleepers of this item and its contents read with deferRegistration set.
+	void registerLoadedAttributes();
 
 	void setDefaultDuration();
 	uint32_t getDefaultDurationMin() const { return items[id].decayTimeMin * 1000; }
@@ -928,6 +935,7 @@ protected:
 
 private:
 	std::string getWeightDescription(uint32_t weight) const;
+	void copyAttributes(const Item& other);
 
 	std::unique_ptr<ItemAttributes> attributes;
 
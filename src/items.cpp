@@ -323,6 +323,7 @@ void Items::clear()
 
 bool Items::reload()
 {
+	++generation;
 	clear();
 	loadFromOtb("data/items/items.otb");
 
@@ -391,7 +392,7 @@ bool Items::loadFromOtb(const std::string& file)
 		return false;
 	}
 
-	for (auto& itemNode : root.children) {
+	for (auto& itemNode : root.children()) {
 		PropStream stream;
 		if (!loader.getProps(itemNode, stream)) {
 			return false;
@@ -447,6 +447,8 @@ public:
 	const InventoryVector& getInventory() const { return inventory; }
 
 	size_t size() const { return items.size(); }
+	// bumped by every reload, which may change the client ids and flags of any item type
+	uint32_t getGeneration() const { return generation; }
 
 	NameMap nameToItems;
 	CurrencyMap currencyItems;
@@ -454,6 +456,7 @@ public:
 private:
 	std::vector<ItemType> items;
 	InventoryVector inventory;
+	uint32_t generation = 0;
 	class ClientIdToServerIdMap
 	{
 	public:
@@ -11,6 +11,8 @@
 #include "monsters.h"
 #include "script.h"
 #include "talkaction.h"
+#include "taskstats.h"
+#include "workerpool.h"
 
 extern Events* g_events;
 extern Vocations g_vocations;
@@ -69,14 +71,16 @@ int luaGameLoadMap(lua_State* L)
 {
 	// Game.loadMap(path)
 	const std::string& path = getString(L, 1);
-	g_dispatcher.addTask([path]() {
-		try {
-			g_game.loadMap(path);
-		} catch (const std::exception& e) {
-			// FIXME: Should only catch some exceptions
-			std::cout << "[Error - luaGameLoadMap] Failed to load map: " << e.what() << std::endl;
-		}
-	});
+	g_dispatcher.addTask(
+	    [path]() {
+		    try {
+			    g_game.loadMap(path);
+		    } catch (const std::exception& e) {
+			    // FIXME: Should only catch some exceptions
+			    std::cout << "[Error - luaGameLoadMap] Failed to load map: " << e.what() << std::endl;
+		    }
+	    },
+	    {TASK_CATEGORY_LUA});
 	return 0;
 }
 
@@ -589,6 +593,86 @@ int luaGameGetClientVersion(lua_State* L)
 	return 1;
 }
 
+int luaGameGetTickStats(lua_State* L)
+{
+	// Game.getTickStats()
+	if (!g_game.hasFixedTick()) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	};
+
+	const GameTickStats& stats = g_game.getTickStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "ticks", stats.ticks);
+	setField(L, "overruns", stats.overruns);
+	setField(L, "skippedTicks", stats.skippedTicks);
+	setField(L, "totalTime", toMicroseconds(stats.total));
+	setField(L, "maxTime", toMicroseconds(stats.max));
+
+	lua_createtable(L, 0, stats.phases.size());
+	for (size_t phase = 0; phase < stats.phases.size(); ++phase) {
+		const GameTickPhaseStats& phaseStats = stats.phases[phase];
+		lua_createtable(L, 0, 4);
+		setField(L, "runs", phaseStats.runs);
+		setField(L, "deferrals", phaseStats.deferrals);
+		setField(L, "totalTime", toMicroseconds(phaseStats.total));
+		setField(L, "maxTime", toMicroseconds(phaseStats.max));
+		lua_setfield(L, -2, getGameTickPhaseName(static_cast<GameTickPhase_t>(phase)));
+	}
+	lua_setfield(L, -2, "phases");
+	return 1;
+}
+
+int luaGameGetTaskStatistics(lua_State* L)
+{
+	// Game.getTaskStatistics([limit = 0])
+	pushString(L, TaskStatistics::getReport(getInteger<uint32_t>(L, 1, 0)));
+	return 1;
+}
+
+int luaGameSetTaskStatisticsEnabled(lua_State* L)
+{
+	// Game.setTaskStatisticsEnabled(enabled)
+	TaskStatistics::setEnabled(getBoolean(L, 1));
+	pushBoolean(L, true);
+	return 1;
+}
+
+int luaGameResetTaskStatistics(lua_State* L)
+{
+	// Game.resetTaskStatistics()
+	TaskStatistics::reset();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int luaGameGetWorkerStats(lua_State* L)
+{
+	// Game.getWorkerStats()
+	auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	};
+
+	const std::vector<WorkerStats> stats = g_workerPool.getStats();
+	const std::chrono::nanoseconds uptime = g_workerPool.getUptime();
+	lua_createtable(L, stats.size(), 0);
+	for (size_t i = 0; i < stats.size(); ++i) {
+		const WorkerStats& workerStats = stats[i];
+		lua_createtable(L, 0, 4);
+		setField(L, "jobs", workerStats.jobs);
+		setField(L, "steals", workerStats.steals);
+		setField(L, "busyTime", toMicroseconds(workerStats.busyTime));
+		setField(L, "utilization",
+		         uptime.count() != 0 ? static_cast<double>(workerStats.busyTime.count()) / uptime.count() : 0.);
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
 int luaGameReload(lua_State* L)
 {
 	// Game.reload(reloadType)
@@ -752,6 +836,11 @@ void LuaScriptInterface::registerGame()
 	registerMethod("Game", "sendAnimatedText", luaGameSendAnimatedText);
 
 	registerMethod("Game", "getClientVersion", luaGameGetClientVersion);
+	registerMethod("Game", "getTickStats", luaGameGetTickStats);
+	registerMethod("Game", "getTaskStatistics", luaGameGetTaskStatistics);
+	registerMethod("Game", "setTaskStatisticsEnabled", luaGameSetTaskStatisticsEnabled);
+	registerMethod("Game", "resetTaskStatistics", luaGameResetTaskStatistics);
+	registerMethod("Game", "getWorkerStats", luaGameGetWorkerStats);
 
 	registerMethod("Game", "reload", luaGameReload);
 
@@ -390,7 +390,9 @@ int luaItemGetAttribute(lua_State* L)
 		attribute = ITEM_ATTRIBUTE_NONE;
 	}
 
-	if (ItemAttributes::isIntAttrType(attribute)) {
+	if (attribute == ITEM_ATTRIBUTE_DURATION) {
+		lua_pushinteger(L, item->getDuration());
+	} else if (ItemAttributes::isIntAttrType(attribute)) {
 		lua_pushinteger(L, item->getIntAttr(attribute));
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		pushString(L, item->getStrAttr(attribute));
@@ -425,7 +427,13 @@ int luaItemSetAttribute(lua_State* L)
 			return 1;
 		}
 
-		item->setIntAttr(attribute, getInteger<int32_t>(L, 3));
+		if (attribute == ITEM_ATTRIBUTE_DURATION) {
+			item->setDuration(getInteger<int32_t>(L, 3));
+		} else if (attribute == ITEM_ATTRIBUTE_DECAYSTATE) {
+			item->setDecaying(getInteger<ItemDecayState_t>(L, 3));
+		} else {
+			item->setIntAttr(attribute, getInteger<int32_t>(L, 3));
+		}
 		pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, getString(L, 3));
@@ -141,6 +141,18 @@ int luaMonsterSetIdle(lua_State* L)
 	return 1;
 }
 
+int luaMonsterIsHibernating(lua_State* L)
+{
+	// monster:isHibernating()
+	Monster* monster = getUserdata<Monster>(L, 1);
+	if (monster) {
+		pushBoolean(L, monster->isHibernating());
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
 int luaMonsterIsTarget(lua_State* L)
 {
 	// monster:isTarget(creature)
@@ -422,6 +434,7 @@ void LuaScriptInterface::registerMonster()
 
 	registerMethod("Monster", "isIdle", luaMonsterIsIdle);
 	registerMethod("Monster", "setIdle", luaMonsterSetIdle);
+	registerMethod("Monster", "isHibernating", luaMonsterIsHibernating);
 
 	registerMethod("Monster", "isTarget", luaMonsterIsTarget);
 	registerMethod("Monster", "isOpponent", luaMonsterIsOpponent);
@@ -97,6 +97,25 @@ int luaPlayerGetIp(lua_State* L)
 	return 1;
 }
 
+int luaPlayerGetCompressionStats(lua_State* L)
+{
+	// player:getCompressionStats()
+	const Player* player = getUserdata<const Player>(L, 1);
+	if (!player) {
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const CompressionStats stats = player->getCompressionStats();
+	lua_createtable(L, 0, 5);
+	setField(L, "messages", stats.messages);
+	setField(L, "bytesIn", stats.bytesIn);
+	setField(L, "bytesOut", stats.bytesOut);
+	setField(L, "bytesSaved", stats.bytesIn - stats.bytesOut);
+	setField(L, "time", std::chrono::duration_cast<std::chrono::microseconds>(stats.time).count());
+	return 1;
+}
+
 int luaPlayerGetAccountId(lua_State* L)
 {
 	// player:getAccountId()
@@ -2283,6 +2302,7 @@ void LuaScriptInterface::registerPlayer()
 
 	registerMethod("Player", "getGuid", luaPlayerGetGuid);
 	registerMethod("Player", "getIp", luaPlayerGetIp);
+	registerMethod("Player", "getCompressionStats", luaPlayerGetCompressionStats);
 	registerMethod("Player", "getAccountId", luaPlayerGetAccountId);
 	registerMethod("Player", "getLastLoginSaved", luaPlayerGetLastLoginSaved);
 	registerMethod("Player", "getLastLogout", luaPlayerGetLastLogout);
@@ -1821,6 +1821,7 @@ void LuaScriptInterface::registerFunctions()
 	registerEnum(TILESTATE_FLOORCHANGE_SOUTH_ALT);
 	registerEnum(TILESTATE_FLOORCHANGE_EAST_ALT);
 	registerEnum(TILESTATE_SUPPORTS_HANGABLE);
+	registerEnum(TILESTATE_BLOCKPROJECTILE);
 
 	registerEnum(WEAPON_NONE);
 	registerEnum(WEAPON_SWORD);
@@ -2108,6 +2109,11 @@ void LuaScriptInterface::registerFunctions()
 	registerEnumIn("configKeys", ConfigManager::MAX_PACKETS_PER_SECOND);
 	registerEnumIn("configKeys", ConfigManager::STAMINA_REGEN_MINUTE);
 	registerEnumIn("configKeys", ConfigManager::STAMINA_REGEN_PREMIUM);
+	registerEnumIn("configKeys", ConfigManager::GAME_TICK_INTERVAL);
+	registerEnumIn("configKeys", ConfigManager::WORKER_THREADS);
+	registerEnumIn("configKeys", ConfigManager::NETWORK_THREADS);
+	registerEnumIn("configKeys", ConfigManager::PACKET_COMPRESSION_LEVEL);
+	registerEnumIn("configKeys", ConfigManager::PACKET_COMPRESSION_THRESHOLD);
 
 	// os
 	registerMethod("os", "mtime", LuaScriptInterface::luaSystemTime);
@@ -2832,8 +2838,8 @@ int LuaScriptInterface::luaAddEvent(lua_State* L)
 	eventDesc.scriptId = getScriptEnv()->getScriptId();
 
 	auto& lastTimerEventId = g_luaEnvironment.lastEventTimerId;
-	eventDesc.eventId = g_scheduler.addEvent(
-	    createSchedulerTask(delay, [=]() { g_luaEnvironment.executeTimerEvent(lastTimerEventId); }));
+	eventDesc.eventId = g_scheduler.addEvent(createSchedulerTask(
+	    delay, [=]() { g_luaEnvironment.executeTimerEvent(lastTimerEventId); }, {TASK_CATEGORY_LUA}));
 
 	g_luaEnvironment.timerEvents.emplace(lastTimerEventId, std::move(eventDesc));
 	lua_pushinteger(L, lastTimerEventId++);
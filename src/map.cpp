@@ -6,6 +6,7 @@
 #include "map.h"
 
 #include "combat.h"
+#include "configmanager.h"
 #include "creature.h"
 #include "game.h"
 #include "iomap.h"
@@ -62,24 +63,6 @@ bool Map::save()
 	return saved;
 }
 
-Tile* Map::getTile(uint16_t x, uint16_t y, uint8_t z) const
-{
-	if (z >= MAP_MAX_LAYERS) {
-		return nullptr;
-	}
-
-	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
-	if (!leaf) {
-		return nullptr;
-	}
-
-	const Floor* floor = leaf->getFloor(z);
-	if (!floor) {
-		return nullptr;
-	}
-	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
-}
-
 void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 {
 	if (z >= MAP_MAX_LAYERS) {
@@ -87,40 +70,10 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 		return;
 	}
 
-	QTreeLeafNode::newLeaf = false;
-	QTreeLeafNode* leaf = root.createLeaf(x, y, 15);
-
-	if (QTreeLeafNode::newLeaf) {
-		// update north
-		QTreeLeafNode* northLeaf = root.getLeaf(x, y - FLOOR_SIZE);
-		if (northLeaf) {
-			northLeaf->leafS = leaf;
-		}
-
-		// update west leaf
-		QTreeLeafNode* westLeaf = root.getLeaf(x - FLOOR_SIZE, y);
-		if (westLeaf) {
-			westLeaf->leafE = leaf;
-		}
-
-		// update south
-		QTreeLeafNode* southLeaf = root.getLeaf(x, y + FLOOR_SIZE);
-		if (southLeaf) {
-			leaf->leafS = southLeaf;
-		}
-
-		// update east
-		QTreeLeafNode* eastLeaf = root.getLeaf(x + FLOOR_SIZE, y);
-		if (eastLeaf) {
-			leaf->leafE = eastLeaf;
-		}
-	}
-
-	Floor* floor = leaf->createFloor(z);
-	uint32_t offsetX = x & FLOOR_MASK;
-	uint32_t offsetY = y & FLOOR_MASK;
+	MapSector* sector = sectors.createSector(x, y);
+	Floor* floor = sectors.createFloor(*sector, z);
 
-	Tile*& tile = floor->tiles[offsetX][offsetY];
+	Tile*& tile = floor->tiles[x & SECTOR_MASK][y & SECTOR_MASK];
 	if (tile) {
 		TileItemVector* items = newTile->getItemList();
 		if (items) {
@@ -139,6 +92,9 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 	} else {
 		tile = newTile;
 	}
+
+	updateTileBitmaps(*tile);
+	invalidatePathGraph(Position(x, y, z));
 }
 
 void Map::removeTile(uint16_t x, uint16_t y, uint8_t z)
@@ -147,17 +103,7 @@ void Map::removeTile(uint16_t x, uint16_t y, uint8_t z)
 		return;
 	}
 
-	const QTreeLeafNode* leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, x, y);
-	if (!leaf) {
-		return;
-	}
-
-	const Floor* floor = leaf->getFloor(z);
-	if (!floor) {
-		return;
-	}
-
-	Tile* tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+	Tile* tile = sectors.getTile(x, y, z);
 	if (tile) {
 		if (const CreatureVector* creatures = tile->getCreatures()) {
 			for (int32_t i = creatures->size(); --i >= 0;) {
@@ -180,6 +126,8 @@ void Map::removeTile(uint16_t x, uint16_t y, uint8_t z)
 			g_game.internalRemoveItem(ground);
 			tile->setGround(nullptr);
 		}
+
+		invalidatePathGraph(Position(x, y, z));
 	}
 }
 
@@ -250,14 +198,11 @@ bool Map::placeCreature(const Position& centerPos, Creature* creature, bool exte
 	toCylinder->internalAddThing(creature);
 
 	const Position& dest = toCylinder->getPosition();
-	getQTNode(dest.x, dest.y)->addCreature(creature);
-	
-	// Add player to grid for spatial partitioning
-	if (Player* player = creature->getPlayer()) {
-		auto region = std::make_pair(dest.x / GRID_SIZE, dest.y / GRID_SIZE);
-		playerGrid[region].push_back(player);
-	}
-	
+	getMapSector(dest.x, dest.y)->addCreature(creature);
+
+	if (creature->getPlayer()) {
+		wakeMonsters(dest);
+	}
 	return true;
 }
 
@@ -294,22 +239,21 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport /*
 	// remove the creature
 	oldTile.removeThing(&creature, 0);
 
-	QTreeLeafNode* leaf = getQTNode(oldPos.x, oldPos.y);
-	QTreeLeafNode* new_leaf = getQTNode(newPos.x, newPos.y);
+	MapSector* sector = getMapSector(oldPos.x, oldPos.y);
+	MapSector* newSector = getMapSector(newPos.x, newPos.y);
 
-	// Switch the node ownership
-	if (leaf != new_leaf) {
+	// Switch the sector ownership
+	if (sector != newSector) {
 		if (creature.getPlayer()) {
 			g_game.updatePlayerHelpers(*creature.getPlayer());
 		}
 
-		leaf->removeCreature(&creature);
-		new_leaf->addCreature(&creature);
-	}
+		sector->removeCreature(&creature);
+		newSector->addCreature(&creature);
 
-	// Update grid for player movement
-	if (Player* player = creature.getPlayer()) {
-		updatePlayerRegion(player, oldPos, newPos);
+		if (creature.getPlayer()) {
+			wakeMonsters(newPos);
+		}
 	}
 
 	// add the creature
@@ -351,210 +295,181 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport /*
 	newTile.postAddNotification(&creature, &oldTile, 0);
 }
 
+namespace {
+
+// Tile bounds that a spectator query has to visit, floors other than the
+// center one being shifted diagonally the way the client renders them.
+void getSpectatorBounds(const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY,
+                        int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, uint16_t& x1, uint16_t& y1,
+                        uint16_t& x2, uint16_t& y2)
+{
+	auto clamp = [](int32_t v) { return static_cast<uint16_t>(std::min<int32_t>(0xFFFF, std::max<int32_t>(0, v))); };
+
+	int32_t minoffset = centerPos.getZ() - maxRangeZ;
+	x1 = clamp(centerPos.x + minRangeX + minoffset);
+	y1 = clamp(centerPos.y + minRangeY + minoffset);
+
+	int32_t maxoffset = centerPos.getZ() - minRangeZ;
+	x2 = clamp(centerPos.x + maxRangeX + maxoffset);
+	y2 = clamp(centerPos.y + maxRangeY + maxoffset);
+}
+
+} // namespace
+
 void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX,
                                  int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ,
                                  int32_t maxRangeZ, bool onlyPlayers) const
 {
-    // If we're only looking for players, use the optimized grid-based approach
-    if (onlyPlayers) {
-        // Calculate the grid coordinates for the center position
-        int32_t centerGridX = centerPos.x / GRID_SIZE;
-        int32_t centerGridY = centerPos.y / GRID_SIZE;
-        
-        // Calculate how many grid cells we need to check in each direction
-        // Add 1 to account for potential overlap at grid boundaries
-        int32_t gridRangeX = ((maxRangeX + GRID_SIZE - 1) / GRID_SIZE) + 1;
-        int32_t gridRangeY = ((maxRangeY + GRID_SIZE - 1) / GRID_SIZE) + 1;
-        
-        // Check all grid cells that might contain spectators
-        for (int32_t gridY = centerGridY - gridRangeY; gridY <= centerGridY + gridRangeY; ++gridY) {
-            for (int32_t gridX = centerGridX - gridRangeX; gridX <= centerGridX + gridRangeX; ++gridX) {
-                auto gridPos = std::make_pair(gridX, gridY);
-                auto it = playerGrid.find(gridPos);
-                if (it == playerGrid.end()) {
-                    continue;
-                }
-                
-                // Check each player in this grid cell
-                for (Player* player : it->second) {
-                    const Position& playerPos = player->getPosition();
-                    
-                    // Check if player is within the vertical range
-                    if (playerPos.z < minRangeZ || playerPos.z > maxRangeZ) {
-                        continue;
-                    }
-                    
-                    // Check horizontal distance
-                    int32_t dx = std::abs(playerPos.x - centerPos.x);
-                    int32_t dy = std::abs(playerPos.y - centerPos.y);
-                    
-                    if (dx <= maxRangeX && dx >= minRangeX && dy <= maxRangeY && dy >= minRangeY) {
-                        // Player is in range, add to spectators
-                        spectators.emplace_back(player);
-                    }
-                }
-            }
-        }
-    } else {
-        // If we need all creatures, use the original implementation
-        auto min_y = centerPos.y + minRangeY;
-        auto min_x = centerPos.x + minRangeX;
-        auto max_y = centerPos.y + maxRangeY;
-        auto max_x = centerPos.x + maxRangeX;
-
-        int32_t minoffset = centerPos.getZ() - maxRangeZ;
-        uint16_t x1 = static_cast<uint16_t>(std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_x + minoffset))));
-        uint16_t y1 = static_cast<uint16_t>(std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_y + minoffset))));
-
-        int32_t maxoffset = centerPos.getZ() - minRangeZ;
-        uint16_t x2 = static_cast<uint16_t>(std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_x + maxoffset))));
-        uint16_t y2 = static_cast<uint16_t>(std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_y + maxoffset))));
-
-        int32_t startx1 = x1 - (x1 % FLOOR_SIZE);
-        int32_t starty1 = y1 - (y1 % FLOOR_SIZE);
-        int32_t endx2 = x2 - (x2 % FLOOR_SIZE);
-        int32_t endy2 = y2 - (y2 % FLOOR_SIZE);
-
-        const QTreeLeafNode* startLeaf =
-            QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, starty1);
-        const QTreeLeafNode* leafS = startLeaf;
-        const QTreeLeafNode* leafE;
-
-        for (int32_t ny = starty1; ny <= endy2; ny += FLOOR_SIZE) {
-            leafE = leafS;
-            for (int32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
-                if (leafE) {
-                    const CreatureVector& node_list = onlyPlayers ? leafE->player_list : leafE->creature_list;
-                    for (Creature* creature : node_list) {
-                        const Position& cpos = creature->getPosition();
-
-                        if (cpos.z < minRangeZ || cpos.z > maxRangeZ) {
-                            continue;
-                        }
-
-                        int32_t offsetZ = centerPos.getZ() - cpos.z;
-                        if ((min_y + offsetZ) > cpos.y || (max_y + offsetZ) < cpos.y ||
-                            (min_x + offsetZ) > cpos.x || (max_x + offsetZ) < cpos.x) {
-                            continue;
-                        }
-
-                        spectators.emplace_back(creature);
-                    }
-                    leafE = leafE->leafE;
-                } else {
-                    leafE = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, nx + FLOOR_SIZE, ny);
-                }
-            }
-
-            if (leafS) {
-                leafS = leafS->leafS;
-            } else {
-                leafS = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, ny + FLOOR_SIZE);
-            }
-        }
-    }
+	auto min_y = centerPos.y + minRangeY;
+	auto min_x = centerPos.x + minRangeX;
+	auto max_y = centerPos.y + maxRangeY;
+	auto max_x = centerPos.x + maxRangeX;
+
+	uint16_t x1, y1, x2, y2;
+	getSpectatorBounds(centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, x1, y1, x2, y2);
+
+	forEachSector(x1, y1, x2, y2, [&](const MapSector& sector) {
+		for (Creature* creature : onlyPlayers ? sector.getPlayers() : sector.getCreatures()) {
+			const Position& cpos = creature->getPosition();
+			if (cpos.z < minRangeZ || cpos.z > maxRangeZ) {
+				continue;
+			}
+
+			int32_t offsetZ = centerPos.getZ() - cpos.z;
+			if ((min_y + offsetZ) > cpos.y || (max_y + offsetZ) < cpos.y || (min_x + offsetZ) > cpos.x ||
+			    (max_x + offsetZ) < cpos.x) {
+				continue;
+			}
+
+			spectators.emplace_back(creature);
+		}
+	});
 }
 
 void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor /*= false*/,
                         bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/,
                         int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/)
 {
-    if (centerPos.z >= MAP_MAX_LAYERS) {
-        return;
-    }
-
-    // Initialize min/max ranges with defaults if not specified
-    minRangeX = (minRangeX == 0 ? -maxViewportX : -minRangeX);
-    maxRangeX = (maxRangeX == 0 ? maxViewportX : maxRangeX);
-    minRangeY = (minRangeY == 0 ? -maxViewportY : -minRangeY);
-    maxRangeY = (maxRangeY == 0 ? maxViewportY : maxRangeY);
-
-    spectators.clear();
-
-    if (onlyPlayers) {
-        // Use grid-based approach for player-only spectator queries
-        int32_t centerX = centerPos.x / GRID_SIZE;
-        int32_t centerY = centerPos.y / GRID_SIZE;
-        
-        // Search in a 3x3 grid around the center position
-        for (int32_t dx = -1; dx <= 1; ++dx) {
-            for (int32_t dy = -1; dy <= 1; ++dy) {
-                auto region = std::make_pair(centerX + dx, centerY + dy);
-                auto it = playerGrid.find(region);
-                if (it == playerGrid.end()) continue;
-                
-                // Check each player in this grid region
-                for (Player* player : it->second) {
-                    const Position& pos = player->getPosition();
-                    if ((!multifloor && pos.z != centerPos.z) || (onlyPlayers && !player)) continue;
-                    
-                    // Calculate the distance from the center position
-                    int32_t dx = centerPos.x - pos.x;
-                    int32_t dy = centerPos.y - pos.y;
-                    
-                    // Check if the player is within the specified range
-                    if (dx >= minRangeX && dx <= maxRangeX && dy >= minRangeY && dy <= maxRangeY) {
-                        spectators.push_back(player);
-                    }
-                }
-            }
-        }
-        return;
-    }
-
-    // Fall back to standard approach for mixed creatures
-    SpectatorCache& cache = getSpectatorCache();
-    
-    // Modified this section since SpectatorCache is now an unordered_map not a class with enabled/players/creatures members
-    if (!onlyPlayers && minRangeX == -maxViewportX && maxRangeX == maxViewportX &&
-        minRangeY == -maxViewportY && maxRangeY == maxViewportY && multifloor) {
-        // Check if we have a cached result for this position
-        auto it = cache.find(centerPos);
-        if (it != cache.end() && centerPos.z >= MAP_LAYER_LOWER_LIMIT && centerPos.z <= MAP_LAYER_UPPER_LIMIT) {
-            // Use cached spectators
-            spectators = it->second;
-            // Remove from cache after using
-            cache.erase(it);
-            return;
-        }
-    }
-
-    int32_t minRangeZ;
-    int32_t maxRangeZ;
-
-    if (multifloor) {
-        if (centerPos.z > MAP_LAYER_VIEW_LIMIT) {
-            minRangeZ = centerPos.z;
-        } else if (centerPos.z == MAP_LAYER_VIEW_LIMIT) {
-            minRangeZ = centerPos.z;
-            maxRangeZ = centerPos.z + 1;
-        } else if (centerPos.z == MAP_LAYER_VIEW_LIMIT - 1) {
-            minRangeZ = centerPos.z - 1;
-            maxRangeZ = centerPos.z + 2;
-        } else if (centerPos.z == MAP_LAYER_VIEW_LIMIT - 2) {
-            minRangeZ = centerPos.z - 2;
-            maxRangeZ = centerPos.z + 3;
-        } else {
-            minRangeZ = centerPos.z - 3;
-            maxRangeZ = centerPos.z + 4;
-        }
-    } else {
-        minRangeZ = centerPos.z;
-        maxRangeZ = centerPos.z;
-    }
-
-    getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
-                         onlyPlayers);
+	if (centerPos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	minRangeX = (minRangeX == 0 ? -maxViewportX : -minRangeX);
+	maxRangeX = (maxRangeX == 0 ? maxViewportX : maxRangeX);
+	minRangeY = (minRangeY == 0 ? -maxViewportY : -minRangeY);
+	maxRangeY = (maxRangeY == 0 ? maxViewportY : maxRangeY);
+
+	spectators.clear();
+
+	int32_t minRangeZ;
+	int32_t maxRangeZ;
+
+	if (multifloor) {
+		if (centerPos.z > MAP_LAYER_VIEW_LIMIT) {
+			minRangeZ = centerPos.z;
+			maxRangeZ = std::min<int32_t>(centerPos.z + 2, MAP_MAX_LAYERS - 1);
+		} else if (centerPos.z == MAP_LAYER_VIEW_LIMIT) {
+			minRangeZ = centerPos.z;
+			maxRangeZ = centerPos.z + 1;
+		} else if (centerPos.z == MAP_LAYER_VIEW_LIMIT - 1) {
+			minRangeZ = centerPos.z - 1;
+			maxRangeZ = centerPos.z + 2;
+		} else if (centerPos.z == MAP_LAYER_VIEW_LIMIT - 2) {
+			minRangeZ = centerPos.z - 2;
+			maxRangeZ = centerPos.z + 3;
+		} else {
+			minRangeZ = centerPos.z - 3;
+			maxRangeZ = centerPos.z + 4;
+		}
+	} else {
+		minRangeZ = centerPos.z;
+		maxRangeZ = centerPos.z;
+	}
+
+	// only viewport sized queries are cached, they are the vast majority
+	MapSector* sector = nullptr;
+	if (minRangeX == -maxViewportX && maxRangeX == maxViewportX && minRangeY == -maxViewportY &&
+	    maxRangeY == maxViewportY) {
+		sector = getMapSector(centerPos.x, centerPos.y);
+	}
+
+	if (!sector) {
+		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ,
+		                      maxRangeZ, onlyPlayers);
+		return;
+	}
+
+	uint16_t x1, y1, x2, y2;
+	getSpectatorBounds(centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, x1, y1, x2, y2);
+
+	SpectatorCacheEntry* entry = sector->findSpectators(centerPos, multifloor, onlyPlayers);
+	if (entry && isSpectatorCacheValid(entry->stamp, x1, y1, x2, y2, onlyPlayers)) {
+		spectators = entry->spectators;
+		return;
+	}
+
+	getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
+	                      onlyPlayers);
+
+	if (!entry) {
+		entry = &sector->cacheSpectators(centerPos, multifloor, onlyPlayers);
+	}
+	entry->stamp = spectatorClock;
+	entry->spectators = spectators;
 }
 
-void Map::clearSpectatorCache()
+bool Map::isSpectatorCacheValid(uint64_t stamp, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
+                                bool onlyPlayers) const
 {
-    spectatorCache.clear();
+	return forEachSector(x1, y1, x2, y2, [=](const MapSector& sector) {
+		return (onlyPlayers ? sector.playerStamp : sector.creatureStamp) <= stamp;
+	});
 }
 
-void Map::clearPlayersSpectatorCache()
+bool Map::hasPlayersInRange(const Position& pos, int32_t rangeX, int32_t rangeY) const
 {
-    playersSpectatorCache.clear();
+	const uint16_t x1 = static_cast<uint16_t>(std::max<int32_t>(0, pos.x - rangeX));
+	const uint16_t y1 = static_cast<uint16_t>(std::max<int32_t>(0, pos.y - rangeY));
+	const uint16_t x2 = static_cast<uint16_t>(std::min<int32_t>(0xFFFF, pos.x + rangeX));
+	const uint16_t y2 = static_cast<uint16_t>(std::min<int32_t>(0xFFFF, pos.y + rangeY));
+
+	// the walk stops at the first sector holding a player in range
+	return !forEachSector(x1, y1, x2, y2, [&](const MapSector& sector) {
+		return std::none_of(sector.getPlayers().begin(), sector.getPlayers().end(), [&](const Creature* player) {
+			return pos.isInRange(player->getPosition(), rangeX, rangeY);
+		});
+	});
+}
+
+void Map::wakeMonsters(const Position& pos) const
+{
+	const uint16_t x1 = static_cast<uint16_t>(std::max<int32_t>(0, pos.x - Monster::ACTIVATION_RANGE_X));
+	const uint16_t y1 = static_cast<uint16_t>(std::max<int32_t>(0, pos.y - Monster::ACTIVATION_RANGE_Y));
+	const uint16_t x2 = static_cast<uint16_t>(std::min<int32_t>(0xFFFF, pos.x + Monster::ACTIVATION_RANGE_X));
+	const uint16_t y2 = static_cast<uint16_t>(std::min<int32_t>(0xFFFF, pos.y + Monster::ACTIVATION_RANGE_Y));
+
+	forEachSector(x1, y1, x2, y2, [&pos](const MapSector& sector) {
+		for (Creature* creature : sector.getCreatures()) {
+			Monster* monster = creature->getMonster();
+			if (monster && monster->isHibernating() &&
+			    pos.isInRange(monster->getPosition(), Monster::ACTIVATION_RANGE_X, Monster::ACTIVATION_RANGE_Y)) {
+				monster->wakeUp();
+			}
+		}
+	});
+}
+
+void Map::invalidateSpectators(const Position& pos, bool isPlayer)
+{
+	MapSector* sector = getMapSector(pos.x, pos.y);
+	if (!sector) {
+		return;
+	}
+
+	sector->creatureStamp = ++spectatorClock;
+	if (isPlayer) {
+		sector->playerStamp = spectatorClock;
+	}
 }
 
 bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight /*= true*/,
@@ -570,52 +485,166 @@ bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool
 
 bool Map::isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor /*= false*/) const
 {
-	const Tile* tile = getTile(x, y, z);
-	if (!tile) {
+	if (blockFloor) {
+		const Tile* tile = getTile(x, y, z);
+		if (tile && tile->getGround()) {
+			return false;
+		}
+	}
+
+	return !isTileBlockingProjectile(x, y, z);
+}
+
+bool Map::isRowClear(uint16_t x1, uint16_t x2, uint16_t y, uint8_t z) const
+{
+	if (z >= MAP_MAX_LAYERS) {
 		return true;
 	}
 
-	if (blockFloor && tile->getGround()) {
-		return false;
+	for (int32_t x = x1; x <= x2; x = (x | SECTOR_MASK) + 1) {
+		const Floor* floor = sectors.getFloor(x, y, z);
+		if (!floor) {
+			continue;
+		}
+
+		const int32_t first = x & SECTOR_MASK;
+		const int32_t last = std::min<int32_t>(x2 - (x & ~SECTOR_MASK), SECTOR_MASK);
+		const uint32_t mask = ((2u << last) - 1) & ~((1u << first) - 1);
+		if ((floor->blockProjectile[y & SECTOR_MASK] & mask) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Map::updateTileBitmaps(const Tile& tile)
+{
+	const Position& pos = tile.getPosition();
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return;
 	}
 
-	return !tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
+	MapSector* sector = sectors.getSector(pos.x, pos.y);
+	if (!sector) {
+		return;
+	}
+
+	// tiles that are still being loaded are caught up by setTile
+	Floor* floor = sector->floors[pos.z];
+	if (!floor || floor->tiles[pos.x & SECTOR_MASK][pos.y & SECTOR_MASK] != &tile) {
+		return;
+	}
+
+	const uint16_t bit = 1 << (pos.x & SECTOR_MASK);
+	const int32_t row = pos.y & SECTOR_MASK;
+	auto assign = [bit](uint16_t& word, bool value) {
+		if (value) {
+			word |= bit;
+		} else {
+			word &= ~bit;
+		}
+	};
+
+	assign(floor->blockSolid[row], tile.hasFlag(TILESTATE_BLOCKSOLID));
+	assign(floor->blockProjectile[row], tile.hasFlag(TILESTATE_BLOCKPROJECTILE));
+	assign(floor->creatures[row], tile.getCreatureCount() != 0);
 }
 
 namespace {
 
-bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+// lines to targets this close are answered from precomputed rays
+constexpr int32_t SIGHT_RAY_RANGE = Map::maxViewportX;
+constexpr int32_t SIGHT_WINDOW_SIZE = SIGHT_RAY_RANGE * 2 + 1;
+static_assert(SIGHT_WINDOW_SIZE <= 32, "a row of the sight window must fit in a word");
+
+int64_t floorDiv(int64_t a, int64_t b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+/**
+ * Calls func(x, y) for every tile a sight line between two points passes over,
+ * stopping early when func returns false. The line is stepped along its longer
+ * axis from the lower end, rounding with a 0.1 bias, in exact fractions so the
+ * same offsets give the same tiles anywhere on the map.
+ */
+template <typename Func>
+bool forEachSightTile(int32_t x0, int32_t y0, int32_t x1, int32_t y1, Func&& func)
 {
-	float dx = x1 - x0;
-	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
-	float yi = y0 + slope;
+	auto stepLine = [&func](int32_t a0, int32_t b0, int32_t a1, int32_t b1, bool steep) {
+		const int64_t da = a1 - a0;
+		const int64_t db = b1 - b0;
+		for (int32_t a = a0 + 1; a < a1; ++a) {
+			const int32_t b = b0 + static_cast<int32_t>(floorDiv(10 * (a - a0) * db + da, 10 * da));
+			if (!(steep ? func(b, a) : func(a, b))) {
+				return false;
+			}
+		}
+		return true;
+	};
 
-	for (uint16_t x = x0 + 1; x < x1; ++x) {
-		// 0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(std::floor(yi + 0.1), x, z)) {
-			return false;
+	if (x0 == x1 && y0 == y1) {
+		return true;
+	}
+
+	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
+		if (y1 > y0) {
+			return stepLine(y0, x0, y1, x1, true);
 		}
-		yi += slope;
+		return stepLine(y1, x1, y0, x0, true);
 	}
 
-	return true;
+	if (x0 > x1) {
+		return stepLine(x1, y1, x0, y0, false);
+	}
+	return stepLine(x0, y0, x1, y1, false);
 }
 
-bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+/**
+ * The tiles between the origin and every offset within SIGHT_RAY_RANGE, grouped
+ * by row so a ray is tested against a sight window one word per row.
+ */
+class SightRays
 {
-	float dx = x1 - x0;
-	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
-	float yi = y0 + slope;
-
-	for (uint16_t x = x0 + 1; x < x1; ++x) {
-		// 0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(x, std::floor(yi + 0.1), z)) {
-			return false;
+public:
+	struct Row
+	{
+		int32_t y;
+		uint32_t mask;
+	};
+
+	SightRays()
+	{
+		for (int32_t dy = -SIGHT_RAY_RANGE; dy <= SIGHT_RAY_RANGE; ++dy) {
+			for (int32_t dx = -SIGHT_RAY_RANGE; dx <= SIGHT_RAY_RANGE; ++dx) {
+				const size_t first = rows.size();
+				forEachSightTile(0, 0, dx, dy, [this, first](int32_t x, int32_t y) {
+					auto it = std::find_if(rows.begin() + first, rows.end(), [y](const Row& row) { return row.y == y; });
+					if (it == rows.end()) {
+						it = rows.insert(it, {y, 0});
+					}
+					it->mask |= 1u << (x + SIGHT_RAY_RANGE);
+					return true;
+				});
+				offsets[getIndex(dx, dy) + 1] = rows.size();
+			}
 		}
-		yi += slope;
 	}
 
-	return true;
+	const Row* begin(int32_t dx, int32_t dy) const { return rows.data() + offsets[getIndex(dx, dy)]; }
+	const Row* end(int32_t dx, int32_t dy) const { return rows.data() + offsets[getIndex(dx, dy) + 1]; }
+
+private:
+	static size_t getIndex(int32_t dx, int32_t dy)
+	{
+		return (dy + SIGHT_RAY_RANGE) * SIGHT_WINDOW_SIZE + (dx + SIGHT_RAY_RANGE);
+	}
+
+	std::vector<Row> rows;
+	std::array<size_t, SIGHT_WINDOW_SIZE * SIGHT_WINDOW_SIZE + 1> offsets = {};
+};
+
+const SightRays& getSightRays()
+{
+	static const SightRays rays;
+	return rays;
 }
 
 } // namespace
@@ -626,18 +655,96 @@ bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uin
 		return true;
 	}
 
-	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
-		if (y1 > y0) {
-			return checkSteepLine(y0, x0, y1, x1, z);
+	if (y0 == y1) {
+		// straight rows are checked a word at a time
+		return isRowClear(std::min(x0, x1) + 1, std::max(x0, x1) - 1, y0, z);
+	}
+
+	const int32_t dx = x1 - x0;
+	const int32_t dy = y1 - y0;
+	if (std::abs(dx) > SIGHT_RAY_RANGE || std::abs(dy) > SIGHT_RAY_RANGE) {
+		return forEachSightTile(x0, y0, x1, y1, [this, z](int32_t x, int32_t y) { return isTileClear(x, y, z); });
+	}
+
+	const SightRays& rays = getSightRays();
+	for (auto row = rays.begin(dx, dy), end = rays.end(dx, dy); row != end; ++row) {
+		for (uint32_t mask = row->mask; mask != 0; mask &= mask - 1) {
+			const int32_t x = x0 + std::countr_zero(mask) - SIGHT_RAY_RANGE;
+			if (isTileBlockingProjectile(x, y0 + row->y, z)) {
+				return false;
+			}
 		}
-		return checkSteepLine(y1, x1, y0, x0, z);
 	}
+	return true;
+}
 
-	if (x0 > x1) {
-		return checkSlightLine(x1, y1, x0, y0, z);
+uint32_t Map::getProjectileBlockers(int32_t left, int32_t y, uint8_t z) const
+{
+	uint32_t blockers = 0;
+	if (y < 0 || y > std::numeric_limits<uint16_t>::max()) {
+		return blockers;
+	}
+
+	const int32_t right = std::min<int32_t>(left + SIGHT_WINDOW_SIZE - 1, std::numeric_limits<uint16_t>::max());
+	for (int32_t x = std::max(left, 0); x <= right; x = (x | SECTOR_MASK) + 1) {
+		const Floor* floor = sectors.getFloor(x, y, z);
+		if (!floor) {
+			continue;
+		}
+
+		const int32_t first = x & SECTOR_MASK;
+		const int32_t last = std::min<int32_t>(right - (x & ~SECTOR_MASK), SECTOR_MASK);
+		const uint32_t bits = (floor->blockProjectile[y & SECTOR_MASK] & ((2u << last) - 1)) >> first;
+		blockers |= bits << (x - left);
 	}
+	return blockers;
+}
+
+void Map::isSightClear(const Position& fromPos, const std::vector<Position>& toPositions, std::vector<bool>& results,
+                       bool sameFloor /*= false*/) const
+{
+	results.assign(toPositions.size(), false);
+
+	// projectile blockers around fromPos, bit x of word y standing for the
+	// tile at offset (x - SIGHT_RAY_RANGE, y - SIGHT_RAY_RANGE)
+	std::array<uint32_t, SIGHT_WINDOW_SIZE> window;
+	bool windowLoaded = false;
+
+	const SightRays& rays = getSightRays();
+	for (size_t i = 0, size = toPositions.size(); i < size; ++i) {
+		const Position& toPos = toPositions[i];
+		if (toPos.z != fromPos.z) {
+			results[i] = !sameFloor && isSightClear(fromPos, toPos, false);
+			continue;
+		}
+
+		const int32_t dx = toPos.x - fromPos.x;
+		const int32_t dy = toPos.y - fromPos.y;
+		if (std::abs(dx) < 2 && std::abs(dy) < 2) {
+			results[i] = true;
+			continue;
+		}
+
+		bool sightClear;
+		if (std::abs(dx) <= SIGHT_RAY_RANGE && std::abs(dy) <= SIGHT_RAY_RANGE) {
+			if (!windowLoaded) {
+				for (int32_t y = 0; y < SIGHT_WINDOW_SIZE; ++y) {
+					window[y] = getProjectileBlockers(fromPos.x - SIGHT_RAY_RANGE, fromPos.y + y - SIGHT_RAY_RANGE,
+					                                  fromPos.z);
+				}
+				windowLoaded = true;
+			}
 
-	return checkSlightLine(x0, y0, x1, y1, z);
+			sightClear = std::none_of(rays.begin(dx, dy), rays.end(dx, dy), [&window](const SightRays::Row& row) {
+				return (window[row.y + SIGHT_RAY_RANGE] & row.mask) != 0;
+			});
+		} else {
+			sightClear = checkSightLine(fromPos.x, fromPos.y, toPos.x, toPos.y, fromPos.z);
+		}
+
+		// a blocked line may still be clear above it, which only the single check knows about
+		results[i] = sightClear || (!sameFloor && isSightClear(fromPos, toPos, false));
+	}
 }
 
 bool Map::isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor /*= false*/) const
@@ -708,6 +815,14 @@ const Tile* Map::canWalkTo(const Creature& creature, const Position& pos) const
 		return getTile(pos.x, pos.y, pos.z);
 	}
 
+	// solid items stop everything but monsters pushing them out of the way
+	if (isTileBlockingSolid(pos.x, pos.y, pos.z) && creature.getPosition() != pos) {
+		const Monster* monster = creature.getMonster();
+		if (!monster || !monster->canPushItems()) {
+			return nullptr;
+		}
+	}
+
 	// used for non-cached tiles
 	Tile* tile = getTile(pos.x, pos.y, pos.z);
 	if (creature.getTile() != tile) {
@@ -897,20 +1012,63 @@ bool Map::getPathMatching(const Creature& creature, std::vector<Direction>& dirL
 	return true;
 }
 
+bool Map::getPathHierarchical(const Creature& creature, std::vector<Direction>& dirList, const Position& targetPos,
+                              const FindPathParams& fpp)
+{
+	const Position& startPos = creature.getPosition();
+	if (!getBoolean(ConfigManager::HIERARCHICAL_PATHFINDING) || fpp.keepDistance || startPos.z != targetPos.z) {
+		return getPathMatching(creature, dirList, FrozenPathingConditionCall(targetPos), fpp);
+	}
+
+	std::vector<Position> waypoints;
+	if (!pathGraph.findWaypoints(*this, startPos, targetPos, waypoints)) {
+		return getPathMatching(creature, dirList, FrozenPathingConditionCall(targetPos), fpp);
+	}
+
+	// each search only covers the area around the creature, the rest of the
+	// route is refined on a later call once the creature got closer to it
+	static constexpr int32_t maxLegDist = SECTOR_SIZE * 2;
+
+	const Position* nextWaypoint = nullptr;
+	for (const Position& waypoint : waypoints) {
+		if (startPos.getDistanceX(waypoint) > SECTOR_SIZE || startPos.getDistanceY(waypoint) > SECTOR_SIZE) {
+			if (!nextWaypoint) {
+				break;
+			}
+
+			FindPathParams legParams;
+			legParams.fullPathSearch = true;
+			legParams.clearSight = false;
+			legParams.allowDiagonal = fpp.allowDiagonal;
+			legParams.maxSearchDist = maxLegDist;
+			legParams.minTargetDist = 0;
+			legParams.maxTargetDist = 0;
+			return getPathMatching(creature, dirList, FrozenPathingConditionCall(*nextWaypoint), legParams);
+		}
+		nextWaypoint = &waypoint;
+	}
+
+	FindPathParams lastLegParams = fpp;
+	if (lastLegParams.maxSearchDist != 0) {
+		lastLegParams.maxSearchDist = std::max(lastLegParams.maxSearchDist, maxLegDist);
+	}
+	return getPathMatching(creature, dirList, FrozenPathingConditionCall(targetPos), lastLegParams);
+}
+
 // AStarNodes
 
-AStarNodes::AStarNodes(uint32_t x, uint32_t y) : nodes(), openNodes()
+AStarNodes::AStarNodes(uint32_t x, uint32_t y) : nodeTable()
 {
 	curNode = 1;
 	closedNodes = 0;
-	openNodes[0] = true;
 
 	AStarNode& startNode = nodes[0];
 	startNode.parent = nullptr;
 	startNode.x = static_cast<uint16_t>(x);
 	startNode.y = static_cast<uint16_t>(y);
 	startNode.f = 0;
-	nodeTable[(x << 16) | y] = nodes;
+	nodeTable[hashPosition(x, y)] = 1;
+	heapPush(0);
 }
 
 AStarNode* AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f)
@@ -920,43 +1078,44 @@ AStarNode* AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y,
 	}
 
 	size_t retNode = curNode++;
-	openNodes[retNode] = true;
 
 	AStarNode* node = nodes + retNode;
-	nodeTable[(x << 16) | y] = node;
 	node->parent = parent;
 	node->x = static_cast<uint16_t>(x);
 	node->y = static_cast<uint16_t>(y);
 	node->f = f;
+
+	size_t slot = hashPosition(x, y);
+	while (nodeTable[slot] != 0) {
+		slot = (slot + 1) & (NODE_TABLE_SIZE - 1);
+	}
+	nodeTable[slot] = static_cast<uint16_t>(retNode + 1);
+
+	heapPush(static_cast<uint16_t>(retNode));
 	return node;
 }
 
 AStarNode* AStarNodes::getBestNode()
 {
-	if (curNode == 0) {
+	if (heapSize == 0) {
 		return nullptr;
 	}
 
-	int32_t best_node_f = std::numeric_limits<int32_t>::max();
-	int32_t best_node = -1;
-	for (size_t i = 0; i < curNode; i++) {
-		if (openNodes[i] && nodes[i].f < best_node_f) {
-			best_node_f = nodes[i].f;
-			best_node = i;
-		}
-	}
-
-	if (best_node >= 0) {
-		return nodes + best_node;
+	uint16_t best = openHeap[0];
+	heapPosition[best] = NOT_IN_HEAP;
+	if (--heapSize != 0) {
+		openHeap[0] = openHeap[heapSize];
+		heapPosition[openHeap[0]] = 0;
+		heapSiftDown(0);
 	}
-	return nullptr;
+	return nodes + best;
 }
 
 void AStarNodes::closeNode(AStarNode* node)
 {
-	size_t index = node - nodes;
+	[[maybe_unused]] size_t index = node - nodes;
 	assert(index < MAX_NODES);
-	openNodes[index] = false;
+	assert(heapPosition[index] == NOT_IN_HEAP);
 	++closedNodes;
 }
 
@@ -964,9 +1123,12 @@ void AStarNodes::openNode(AStarNode* node)
 {
 	size_t index = node - nodes;
 	assert(index < MAX_NODES);
-	if (!openNodes[index]) {
-		openNodes[index] = true;
+	if (heapPosition[index] == NOT_IN_HEAP) {
+		heapPush(static_cast<uint16_t>(index));
 		--closedNodes;
+	} else {
+		// f only ever decreases here
+		heapSiftUp(heapPosition[index]);
 	}
 }
 
@@ -974,11 +1136,64 @@ int_fast32_t AStarNodes::getClosedNodes() const { return closedNodes; }
 
 AStarNode* AStarNodes::getNodeByPosition(uint32_t x, uint32_t y)
 {
-	auto it = nodeTable.find((x << 16) | y);
-	if (it == nodeTable.end()) {
-		return nullptr;
+	for (size_t slot = hashPosition(x, y); nodeTable[slot] != 0; slot = (slot + 1) & (NODE_TABLE_SIZE - 1)) {
+		AStarNode* node = nodes + (nodeTable[slot] - 1);
+		if (node->x == x && node->y == y) {
+			return node;
+		}
+	}
+	return nullptr;
+}
+
+void AStarNodes::heapPush(uint16_t index)
+{
+	openHeap[heapSize] = index;
+	heapPosition[index] = static_cast<int16_t>(heapSize);
+	heapSiftUp(heapSize++);
+}
+
+void AStarNodes::heapSiftUp(size_t pos)
+{
+	uint16_t index = openHeap[pos];
+	while (pos > 0) {
+		size_t parent = (pos - 1) / 2;
+		if (!heapLess(index, openHeap[parent])) {
+			break;
+		}
+
+		openHeap[pos] = openHeap[parent];
+		heapPosition[openHeap[pos]] = static_cast<int16_t>(pos);
+		pos = parent;
+	}
+
+	openHeap[pos] = index;
+	heapPosition[index] = static_cast<int16_t>(pos);
+}
+
+void AStarNodes::heapSiftDown(size_t pos)
+{
+	uint16_t index = openHeap[pos];
+	while (true) {
+		size_t child = pos * 2 + 1;
+		if (child >= heapSize) {
+			break;
+		}
+
+		if (child + 1 < heapSize && heapLess(openHeap[child + 1], openHeap[child])) {
+			++child;
+		}
+
+		if (!heapLess(openHeap[child], index)) {
+			break;
+		}
+
+		openHeap[pos] = openHeap[child];
+		heapPosition[openHeap[pos]] = static_cast<int16_t>(pos);
+		pos = child;
 	}
-	return it->second;
+
+	openHeap[pos] = index;
+	heapPosition[index] = static_cast<int16_t>(pos);
 }
 
 int_fast32_t AStarNodes::getMapWalkCost(AStarNode* node, const Position& neighborPos)
@@ -993,7 +1208,8 @@ int_fast32_t AStarNodes::getMapWalkCost(AStarNode* node, const Position& neighbo
 int_fast32_t AStarNodes::getTileWalkCost(const Creature& creature, const Tile* tile)
 {
 	int_fast32_t cost = 0;
-	if (tile->getTopVisibleCreature(&creature)) {
+	const Position& tilePos = tile->getPosition();
+	if (g_game.map.hasTileCreatures(tilePos.x, tilePos.y, tilePos.z) && tile->getTopVisibleCreature(&creature)) {
 		// destroy creature cost
 		cost += MAP_NORMALWALKCOST * 3;
 	}
@@ -1019,84 +1235,124 @@ Floor::~Floor()
 	}
 }
 
-// QTreeNode
-QTreeNode::~QTreeNode()
+// MapSector
+void MapSector::addCreature(Creature* c)
 {
-	for (auto* ptr : child) {
-		delete ptr;
+	creature_list.push_back(c);
+
+	if (c->getPlayer()) {
+		player_list.push_back(c);
 	}
 }
 
-QTreeLeafNode* QTreeNode::getLeaf(uint32_t x, uint32_t y)
+void MapSector::removeCreature(Creature* c)
 {
-	if (leaf) {
-		return static_cast<QTreeLeafNode*>(this);
-	}
+	auto iter = std::find(creature_list.begin(), creature_list.end(), c);
+	assert(iter != creature_list.end());
+	*iter = creature_list.back();
+	creature_list.pop_back();
 
-	QTreeNode* node = child[((x & 0x8000) >> 15) | ((y & 0x8000) >> 14)];
-	if (!node) {
-		return nullptr;
+	if (c->getPlayer()) {
+		iter = std::find(player_list.begin(), player_list.end(), c);
+		assert(iter != player_list.end());
+		*iter = player_list.back();
+		player_list.pop_back();
 	}
-	return node->getLeaf(x << 1, y << 1);
 }
 
-QTreeLeafNode* QTreeNode::createLeaf(uint32_t x, uint32_t y, uint32_t level)
+SpectatorCacheEntry* MapSector::findSpectators(const Position& centerPos, bool multifloor, bool onlyPlayers)
 {
-	if (!isLeaf()) {
-		uint32_t index = ((x & 0x8000) >> 15) | ((y & 0x8000) >> 14);
-		if (!child[index]) {
-			if (level != FLOOR_BITS) {
-				child[index] = new QTreeNode();
-			} else {
-				child[index] = new QTreeLeafNode();
-				QTreeLeafNode::newLeaf = true;
-			}
+	for (SpectatorCacheEntry& entry : spectatorCache) {
+		if (entry.centerPos == centerPos && entry.multifloor == multifloor && entry.onlyPlayers == onlyPlayers) {
+			return &entry;
 		}
-		return child[index]->createLeaf(x * 2, y * 2, level - 1);
 	}
-	return static_cast<QTreeLeafNode*>(this);
+	return nullptr;
 }
 
-// QTreeLeafNode
-bool QTreeLeafNode::newLeaf = false;
-
-QTreeLeafNode::~QTreeLeafNode()
+SpectatorCacheEntry& MapSector::cacheSpectators(const Position& centerPos, bool multifloor, bool onlyPlayers)
 {
-	for (auto* ptr : array) {
-		delete ptr;
+	SpectatorCacheEntry* entry;
+	if (spectatorCache.size() < MAX_CACHED_SPECTATORS) {
+		entry = &spectatorCache.emplace_back();
+	} else {
+		// replace the entry that was computed the longest time ago
+		entry = &*std::min_element(spectatorCache.begin(), spectatorCache.end(),
+		                           [](const SpectatorCacheEntry& lhs, const SpectatorCacheEntry& rhs) {
+			                           return lhs.stamp < rhs.stamp;
+		                           });
 	}
+
+	entry->centerPos = centerPos;
+	entry->multifloor = multifloor;
+	entry->onlyPlayers = onlyPlayers;
+	return *entry;
 }
 
-Floor* QTreeLeafNode::createFloor(uint32_t z)
+// MapSectors
+MapSector* MapSectors::createSector(uint16_t x, uint16_t y)
 {
-	if (!array[z]) {
-		array[z] = new Floor();
+	const uint32_t sx = x >> SECTOR_BITS;
+	const uint32_t sy = y >> SECTOR_BITS;
+	if (sx - originX >= width || sy - originY >= height) {
+		grow(sx, sy);
+	}
+
+	MapSector*& sector = directory[(sy - originY) * width + (sx - originX)];
+	if (!sector) {
+		sector = &sectors.emplace_back();
 	}
-	return array[z];
+	return sector;
 }
 
-void QTreeLeafNode::addCreature(Creature* c)
+Floor* MapSectors::createFloor(MapSector& sector, uint8_t z)
 {
-	creature_list.push_back(c);
-
-	if (c->getPlayer()) {
-		player_list.push_back(c);
+	if (!sector.floors[z]) {
+		sector.floors[z] = &floors.emplace_back();
 	}
+	return sector.floors[z];
 }
 
-void QTreeLeafNode::removeCreature(Creature* c)
+void MapSectors::grow(uint32_t sx, uint32_t sy)
 {
-	auto iter = std::find(creature_list.begin(), creature_list.end(), c);
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
+	static constexpr uint32_t maxSectors = 0x10000 >> SECTOR_BITS;
+
+	uint32_t minX = sx, minY = sy, maxX = sx, maxY = sy;
+	if (width != 0) {
+		minX = std::min(minX, originX);
+		minY = std::min(minY, originY);
+		maxX = std::max(maxX, originX + width - 1);
+		maxY = std::max(maxY, originY + height - 1);
+
+		// leave some slack in the direction we grow so loading a map does not
+		// rebuild the directory for every new row or column of sectors
+		if (sx < originX) {
+			minX -= std::min(minX, width / 2);
+		} else if (sx >= originX + width) {
+			maxX = std::min(maxSectors - 1, maxX + width / 2);
+		}
 
-	if (c->getPlayer()) {
-		iter = std::find(player_list.begin(), player_list.end(), c);
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
+		if (sy < originY) {
+			minY -= std::min(minY, height / 2);
+		} else if (sy >= originY + height) {
+			maxY = std::min(maxSectors - 1, maxY + height / 2);
+		}
+	}
+
+	const uint32_t newWidth = maxX - minX + 1;
+	const uint32_t newHeight = maxY - minY + 1;
+
+	std::vector<MapSector*> newDirectory(newWidth * newHeight);
+	for (uint32_t y = 0; y < height; ++y) {
+		std::copy_n(directory.begin() + y * width, width,
+		            newDirectory.begin() + (originY - minY + y) * newWidth + (originX - minX));
 	}
+
+	directory = std::move(newDirectory);
+	originX = minX;
+	originY = minY;
+	width = newWidth;
+	height = newHeight;
 }
 
 uint32_t Map::clean() const
@@ -1140,31 +1396,3 @@ uint32_t Map::clean() const
 	          << (tiles != 1 ? "s" : "") << " in " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	return count;
 }
-
-void Map::updatePlayerRegion(Player* player, const Position& oldPos, const Position& newPos) 
-{
-    auto oldRegion = std::make_pair(oldPos.x / GRID_SIZE, oldPos.y / GRID_SIZE);
-    auto newRegion = std::make_pair(newPos.x / GRID_SIZE, newPos.y / GRID_SIZE);
-    
-    if (oldRegion != newRegion) {
-        // Remove from old region
-        auto& oldVec = playerGrid[oldRegion];
-        oldVec.erase(std::remove(oldVec.begin(), oldVec.end(), player), oldVec.end());
-        
-        // Add to new region
-        playerGrid[newRegion].push_back(player);
-        
-        // Log grid changes for debugging (uncomment for debugging)
-        /*
-        std::cout << "Player " << player->getName() << " moved from region (" 
-                 << oldRegion.first << "," << oldRegion.second 
-                 << ") to (" << newRegion.first << "," << newRegion.second 
-                 << "). Grid now has " << playerGrid.size() << " regions." << std::endl;
-        */
-    }
-}
-
-SpectatorCache& Map::getSpectatorCache()
-{
-    return spectatorCache;
-}
@@ -7,6 +7,7 @@
 #include "otpch.h"
 
 #include "house.h"
+#include "pathgraph.h"
 #include "position.h"
 #include "spawn.h"
 #include "spectators.h"
@@ -22,17 +23,6 @@ inline constexpr int32_t MAP_LAYER_VIEW_LIMIT = 7;
 inline constexpr int32_t MAP_LAYER_LOWER_LIMIT = 0;
 inline constexpr int32_t MAP_LAYER_UPPER_LIMIT = 15;
 
-// Grid size for spatial partitioning (32x32 tiles per grid cell)
-inline constexpr int32_t GRID_SIZE = 32;
-
-// Add grid-based spatial partitioning
-struct pair_hash {
-	template <class T1, class T2>
-	std::size_t operator()(const std::pair<T1, T2>& p) const {
-		return std::hash<T1>{}(p.first) ^ std::hash<T2>{}(p.second);
-	}
-};
-
 struct FindPathParams;
 struct AStarNode
 {
@@ -62,32 +52,40 @@ public:
 	static int_fast32_t getTileWalkCost(const Creature& creature, const Tile* tile);
 
 private:
+	// open addressing table from position to node index + 1, kept at most half full
+	static constexpr size_t NODE_TABLE_SIZE = MAX_NODES * 2;
+	static constexpr int16_t NOT_IN_HEAP = -1;
+
+	static size_t hashPosition(uint32_t x, uint32_t y)
+	{
+		return (((x << 16) | y) * UINT32_C(0x9E3779B1)) >> 22;
+	}
+	static_assert(NODE_TABLE_SIZE == (1 << (32 - 22)), "hashPosition must cover NODE_TABLE_SIZE");
+
+	bool heapLess(uint16_t lhs, uint16_t rhs) const
+	{
+		// ties go to the older node, matching the order of a linear scan
+		return nodes[lhs].f < nodes[rhs].f || (nodes[lhs].f == nodes[rhs].f && lhs < rhs);
+	}
+	void heapPush(uint16_t index);
+	void heapSiftUp(size_t pos);
+	void heapSiftDown(size_t pos);
+
 	AStarNode nodes[MAX_NODES];
-	bool openNodes[MAX_NODES];
-	std::unordered_map<uint32_t, AStarNode*> nodeTable;
+	uint16_t nodeTable[NODE_TABLE_SIZE];
+
+	// binary min-heap of open node indexes ordered by f
+	uint16_t openHeap[MAX_NODES];
+	int16_t heapPosition[MAX_NODES];
+	size_t heapSize = 0;
+
 	size_t curNode;
 	int_fast32_t closedNodes;
 };
 
-// Position hash function for unordered_map
-namespace std {
-	template<>
-	struct hash<Position> {
-		std::size_t operator()(const Position& pos) const {
-			// Combine the hash of the coordinates
-			std::size_t h1 = std::hash<int32_t>{}(pos.x);
-			std::size_t h2 = std::hash<int32_t>{}(pos.y);
-			std::size_t h3 = std::hash<int32_t>{}(pos.z);
-			return h1 ^ (h2 << 1) ^ (h3 << 2);
-		}
-	};
-}
-
-using SpectatorCache = std::unordered_map<Position, SpectatorVec>;
-
-inline constexpr int32_t FLOOR_BITS = 3;
-inline constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
-inline constexpr int32_t FLOOR_MASK = (FLOOR_SIZE - 1);
+inline constexpr int32_t SECTOR_BITS = 4;
+inline constexpr int32_t SECTOR_SIZE = (1 << SECTOR_BITS);
+inline constexpr int32_t SECTOR_MASK = (SECTOR_SIZE - 1);
 
 struct Floor
 {
@@ -98,82 +96,135 @@ struct Floor
 	Floor(const Floor&) = delete;
 	Floor& operator=(const Floor&) = delete;
 
-	Tile* tiles[FLOOR_SIZE][FLOOR_SIZE] = {};
+	Tile* tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
+
+	// bit x of word y mirrors the state of the tile at that offset, see Map::updateTileBitmaps
+	using Bitmap = std::array<uint16_t, SECTOR_SIZE>;
+	Bitmap blockSolid = {};
+	Bitmap blockProjectile = {};
+	Bitmap creatures = {};
 };
 
 class FrozenPathingConditionCall;
-class QTreeLeafNode;
 
-class QTreeNode
+/**
+ * The result of a viewport sized getSpectators call, kept by the sector
+ * containing its center until a creature moves in one of the sectors it covers.
+ */
+struct SpectatorCacheEntry
+{
+	Position centerPos;
+	bool multifloor = false;
+	bool onlyPlayers = false;
+	uint64_t stamp = 0;
+	SpectatorVec spectators;
+};
+
+/**
+ * A fixed SECTOR_SIZE x SECTOR_SIZE column of the map, holding the tiles of
+ * every floor plus the creatures standing anywhere inside it.
+ */
+class MapSector
 {
 public:
-	constexpr QTreeNode() = default;
-	virtual ~QTreeNode();
+	MapSector() = default;
 
 	// non-copyable
-	QTreeNode(const QTreeNode&) = delete;
-	QTreeNode& operator=(const QTreeNode&) = delete;
+	MapSector(const MapSector&) = delete;
+	MapSector& operator=(const MapSector&) = delete;
 
-	bool isLeaf() const { return leaf; }
+	Floor* getFloor(uint8_t z) const { return floors[z]; }
 
-	QTreeLeafNode* getLeaf(uint32_t x, uint32_t y);
+	const CreatureVector& getCreatures() const { return creature_list; }
+	const CreatureVector& getPlayers() const { return player_list; }
 
-	template <typename Leaf, typename Node>
-	static Leaf getLeafStatic(Node node, uint32_t x, uint32_t y)
-	{
-		do {
-			node = node->child[((x & 0x8000) >> 15) | ((y & 0x8000) >> 14)];
-			if (!node) {
-				return nullptr;
-			}
+	void addCreature(Creature* c);
+	void removeCreature(Creature* c);
 
-			x <<= 1;
-			y <<= 1;
-		} while (!node->leaf);
-		return static_cast<Leaf>(node);
-	}
+	SpectatorCacheEntry* findSpectators(const Position& centerPos, bool multifloor, bool onlyPlayers);
+	SpectatorCacheEntry& cacheSpectators(const Position& centerPos, bool multifloor, bool onlyPlayers);
 
-	QTreeLeafNode* createLeaf(uint32_t x, uint32_t y, uint32_t level);
+private:
+	static constexpr size_t MAX_CACHED_SPECTATORS = 8;
 
-protected:
-	bool leaf = false;
+	Floor* floors[MAP_MAX_LAYERS] = {};
+	CreatureVector creature_list;
+	CreatureVector player_list;
 
-private:
-	QTreeNode* child[4] = {};
+	// stamps of the last creature (or player) change inside this sector
+	uint64_t creatureStamp = 0;
+	uint64_t playerStamp = 0;
+	// stamp of the last walkability change of a tile inside this sector, on any floor
+	uint64_t walkabilityStamp = 0;
+	std::vector<SpectatorCacheEntry> spectatorCache;
 
 	friend class Map;
+	friend class MapSectors;
 };
 
-class QTreeLeafNode final : public QTreeNode
+/**
+ * Flat, sector indexed tile storage.
+ * Sectors and floors live in chunked arenas with stable addresses, and a
+ * row-major directory covering the bounding box of the loaded map maps a
+ * sector coordinate to its sector with plain address arithmetic.
+ */
+class MapSectors
 {
 public:
-	QTreeLeafNode()
+	MapSectors() = default;
+
+	// non-copyable
+	MapSectors(const MapSectors&) = delete;
+	MapSectors& operator=(const MapSectors&) = delete;
+
+	MapSector* getSector(uint16_t x, uint16_t y) const
 	{
-		leaf = true;
-		newLeaf = true;
+		const uint32_t sx = static_cast<uint32_t>(x >> SECTOR_BITS) - originX;
+		const uint32_t sy = static_cast<uint32_t>(y >> SECTOR_BITS) - originY;
+		if (sx >= width || sy >= height) {
+			return nullptr;
+		}
+		return directory[sy * width + sx];
 	}
-	~QTreeLeafNode();
 
-	// non-copyable
-	QTreeLeafNode(const QTreeLeafNode&) = delete;
-	QTreeLeafNode& operator=(const QTreeLeafNode&) = delete;
+	Tile* getTile(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		const MapSector* sector = getSector(x, y);
+		if (!sector) {
+			return nullptr;
+		}
+
+		const Floor* floor = sector->floors[z];
+		if (!floor) {
+			return nullptr;
+		}
+		return floor->tiles[x & SECTOR_MASK][y & SECTOR_MASK];
+	}
 
-	Floor* createFloor(uint32_t z);
-	Floor* getFloor(uint8_t z) const { return array[z]; }
+	const Floor* getFloor(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		const MapSector* sector = getSector(x, y);
+		if (!sector) {
+			return nullptr;
+		}
+		return sector->floors[z];
+	}
 
-	void addCreature(Creature* c);
-	void removeCreature(Creature* c);
+	MapSector* createSector(uint16_t x, uint16_t y);
+	Floor* createFloor(MapSector& sector, uint8_t z);
 
 private:
-	static bool newLeaf;
-	QTreeLeafNode* leafS = nullptr;
-	QTreeLeafNode* leafE = nullptr;
-	Floor* array[MAP_MAX_LAYERS] = {};
-	CreatureVector creature_list;
-	CreatureVector player_list;
+	void grow(uint32_t sx, uint32_t sy);
 
-	friend class Map;
-	friend class QTreeNode;
+	// deques never relocate their elements, so pointers into them stay valid
+	std::deque<MapSector> sectors;
+	std::deque<Floor> floors;
+
+	std::vector<MapSector*> directory;
+	uint32_t originX = 0;
+	uint32_t originY = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
 };
 
 /**
@@ -189,9 +240,6 @@ public:
 	static constexpr int32_t maxClientViewportX = 8;
 	static constexpr int32_t maxClientViewportY = 6;
 
-	static constexpr int32_t GRID_SIZE = 32; // Adjust based on map size and player density
-	void updatePlayerRegion(Player* player, const Position& oldPos, const Position& newPos);
-
 	uint32_t clean() const;
 
 	/**
@@ -210,9 +258,37 @@ public:
 	 * Get a single tile.
 	 * \returns A pointer to that tile.
 	 */
-	Tile* getTile(uint16_t x, uint16_t y, uint8_t z) const;
+	Tile* getTile(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		if (z >= MAP_MAX_LAYERS) {
+			return nullptr;
+		}
+		return sectors.getTile(x, y, z);
+	}
 	Tile* getTile(const Position& pos) const { return getTile(pos.x, pos.y, pos.z); }
 
+	/**
+	 * Refreshes the bits kept for the tile in its floor bitmaps.
+	 * Must be called whenever the flags or creatures of a tile change.
+	 */
+	void updateTileBitmaps(const Tile& tile);
+
+	bool isTileBlockingSolid(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		return testTileBit(&Floor::blockSolid, x, y, z);
+	}
+	bool isTileBlockingProjectile(uint16_t x, uint16_t y, uint8_t z) const
+	{
+		return testTileBit(&Floor::blockProjectile, x, y, z);
+	}
+	bool hasTileCreatures(uint16_t x, uint16_t y, uint8_t z) const { return testTileBit(&Floor::creatures, x, y, z); }
+
+	/**
+	 * Checks a whole row of tiles for projectile blockers, a word at a time.
+	 * \returns true if no tile from x1 to x2 (inclusive) blocks projectiles
+	 */
+	bool isRowClear(uint16_t x1, uint16_t x2, uint16_t y, uint8_t z) const;
+
 	/**
 	 * Set a single tile.
 	 */
@@ -242,33 +318,48 @@ public:
 	                   bool onlyPlayers = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0,
 	                   int32_t maxRangeY = 0);
 
-	void clearSpectatorCache();
-	void clearPlayersSpectatorCache();
-	void clearPlayerGrid() { playerGrid.clear(); }
-	SpectatorCache& getSpectatorCache();
-
-	// Debug function to get grid statistics
-	std::string getGridStats() const {
-		size_t totalPlayers = 0;
-		size_t emptyRegions = 0;
-		size_t maxPlayersInRegion = 0;
-		
-		for (const auto& [region, players] : playerGrid) {
-			totalPlayers += players.size();
-			if (players.empty()) {
-				emptyRegions++;
+	/**
+	 * Invalidates the cached spectators of every query covering the sector of pos.
+	 * Must be called whenever a creature enters or leaves a tile.
+	 */
+	void invalidateSpectators(const Position& pos, bool isPlayer);
+
+	/**
+	 * Calls func(const MapSector&) for every sector overlapping the given tile rectangle.
+	 * If func returns bool, returning false stops the walk and forEachSector returns false as well.
+	 */
+	template <typename Func>
+	bool forEachSector(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, Func&& func) const
+	{
+		for (int32_t ny = y1 & ~SECTOR_MASK; ny <= y2; ny += SECTOR_SIZE) {
+			for (int32_t nx = x1 & ~SECTOR_MASK; nx <= x2; nx += SECTOR_SIZE) {
+				const MapSector* sector = sectors.getSector(nx, ny);
+				if (!sector) {
+					continue;
+				}
+
+				if constexpr (std::is_same_v<std::invoke_result_t<Func&, const MapSector&>, bool>) {
+					if (!func(*sector)) {
+						return false;
+					}
+				} else {
+					func(*sector);
+				}
 			}
-			maxPlayersInRegion = std::max(maxPlayersInRegion, players.size());
 		}
-		
-		std::stringstream ss;
-		ss << "Grid stats: " << playerGrid.size() << " regions, "
-		   << totalPlayers << " players, "
-		   << emptyRegions << " empty regions, "
-		   << "max " << maxPlayersInRegion << " players in a region";
-		return ss.str();
+		return true;
 	}
 
+	/**
+	 * Checks if any player stands within rangeX/rangeY tiles of pos, on any floor.
+	 */
+	bool hasPlayersInRange(const Position& pos, int32_t rangeX, int32_t rangeY) const;
+
+	/**
+	 * Wakes the hibernating monsters within their activation range of pos, called when a player enters a sector.
+	 */
+	void wakeMonsters(const Position& pos) const;
+
 	/**
 	 * Checks if you can throw an object to that position
 	 *	\param fromPos from Source point
@@ -298,6 +389,15 @@ public:
 	 *floor \returns The result if there is no obstacles
 	 */
 	bool isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor = false) const;
+
+	/**
+	 * Checks isSightClear from fromPos to many positions at once.
+	 * Nearby targets share one read of the surrounding blocking bitmaps and
+	 * precomputed rays, so this is much cheaper than checking them one by one.
+	 * \param results receives the result for each position, in the same order
+	 */
+	void isSightClear(const Position& fromPos, const std::vector<Position>& toPositions, std::vector<bool>& results,
+	                  bool sameFloor = false) const;
 	bool checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z) const;
 
 	const Tile* canWalkTo(const Creature& creature, const Position& pos) const;
@@ -305,13 +405,50 @@ public:
 	bool getPathMatching(const Creature& creature, std::vector<Direction>& dirList,
 	                     const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp) const;
 
-	std::unordered_map<std::string, Position> waypoints;
+	/**
+	 * Finds a path towards targetPos like getPathMatching, but routes it through
+	 * the hierarchical path graph first when enabled. If the route leaves the
+	 * range of a single search, only the steps up to the last cluster entrance
+	 * within that range are returned.
+	 */
+	bool getPathHierarchical(const Creature& creature, std::vector<Direction>& dirList, const Position& targetPos,
+	                         const FindPathParams& fpp);
+
+	/**
+	 * Must be called whenever a tile changes whether it can be walked on.
+	 */
+	void invalidatePathGraph(const Position& pos)
+	{
+		pathGraph.invalidate(pos);
+		++walkabilityStamp;
+		if (MapSector* sector = getMapSector(pos.x, pos.y)) {
+			sector->walkabilityStamp = walkabilityStamp;
+		}
+	}
 
-	QTreeLeafNode* getQTNode(uint16_t x, uint16_t y)
+	/**
+	 * Checks that no tile in the sectors overlapping the given rectangle changed
+	 * whether it can be walked on since getWalkabilityStamp returned stamp.
+	 */
+	bool isWalkabilityUnchanged(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint64_t stamp) const
 	{
-		return QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, x, y);
+		return forEachSector(x1, y1, x2, y2, [=](const MapSector& sector) { return sector.walkabilityStamp <= stamp; });
 	}
 
+	/**
+	 * Keeps the path graph bounded, only while no path search runs.
+	 */
+	void trimPathGraph() { pathGraph.trim(); }
+
+	/**
+	 * Changes every time a tile changes whether it can be walked on.
+	 */
+	uint64_t getWalkabilityStamp() const { return walkabilityStamp; }
+
+	std::unordered_map<std::string, Position> waypoints;
+
+	MapSector* getMapSector(uint16_t x, uint16_t y) const { return sectors.getSector(x, y); }
+
 	Spawns spawns;
 	Towns towns;
 	Houses houses;
@@ -321,10 +458,25 @@ public:
 	                           int32_t maxRangeZ, bool onlyPlayers = false) const;
 
 private:
-	SpectatorCache spectatorCache;
-	SpectatorCache playersSpectatorCache;
+	bool testTileBit(Floor::Bitmap Floor::*bitmap, uint16_t x, uint16_t y, uint8_t z) const
+	{
+		if (z >= MAP_MAX_LAYERS) {
+			return false;
+		}
+
+		const Floor* floor = sectors.getFloor(x, y, z);
+		return floor && ((floor->*bitmap)[y & SECTOR_MASK] >> (x & SECTOR_MASK) & 1) != 0;
+	}
 
-	QTreeNode root;
+	uint32_t getProjectileBlockers(int32_t left, int32_t y, uint8_t z) const;
+
+	bool isSpectatorCacheValid(uint64_t stamp, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
+	                           bool onlyPlayers) const;
+
+	MapSectors sectors;
+	uint64_t spectatorClock = 0;
+	PathGraph pathGraph;
+	uint64_t walkabilityStamp = 1;
 
 	std::filesystem::path spawnfile;
 	std::filesystem::path housefile;
@@ -332,9 +484,6 @@ private:
 	uint32_t width = 0;
 	uint32_t height = 0;
 
-	// Grid-based spatial partitioning for players
-	std::unordered_map<std::pair<int32_t, int32_t>, std::vector<Player*>, pair_hash> playerGrid;
-
 	friend class Game;
 	friend class IOMap;
 };
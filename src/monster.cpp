@@ -502,12 +502,30 @@ bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAUL
 	std::list<Creature*> resultList;
 	const Position& myPos = getPosition();
 
-	for (Creature* creature : targetList) {
-		if (followCreature != creature && isTarget(creature)) {
-			if (searchType == TARGETSEARCH_RANDOM || canUseAttack(myPos, creature)) {
+	if (searchType == TARGETSEARCH_RANDOM || !isHostile()) {
+		for (Creature* creature : targetList) {
+			if (followCreature != creature && isTarget(creature)) {
 				resultList.push_back(creature);
 			}
 		}
+	} else {
+		// check the line of sight to every target in range at once
+		std::vector<Creature*> inRange;
+		std::vector<Position> inRangePositions;
+		for (Creature* creature : targetList) {
+			if (followCreature != creature && isTarget(creature) && hasAttackInRange(myPos, creature)) {
+				inRange.push_back(creature);
+				inRangePositions.push_back(creature->getPosition());
+			}
+		}
+
+		std::vector<bool> sightClear;
+		g_game.map.isSightClear(myPos, inRangePositions, sightClear, true);
+		for (size_t i = 0, size = inRange.size(); i < size; ++i) {
+			if (sightClear[i]) {
+				resultList.push_back(inRange[i]);
+			}
+		}
 	}
 
 	switch (searchType) {
@@ -648,7 +666,7 @@ bool Monster::selectTarget(Creature* creature)
 
 	if (isHostile() || isSummon()) {
 		if (setAttackedCreature(creature) && !isSummon()) {
-			g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); });
+			g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); }, {TASK_CATEGORY_CREATURE});
 		}
 	}
 	return setFollowCreature(creature);
@@ -660,18 +678,48 @@ void Monster::setIdle(bool idle)
 		return;
 	}
 
+	const bool wasIdle = isIdle;
 	isIdle = idle;
 
-	if (!isIdle) {
-		g_game.addCreatureCheck(this);
-	} else {
-		onIdleStatus();
+	if (isIdle) {
+		// onIdleStatus updates the idle status again, only run it when the monster becomes idle
+		if (!wasIdle) {
+			onIdleStatus();
+		}
 		clearTargetList();
 		clearFriendList();
+	}
+
+	hibernating = isIdle && canHibernate();
+	if (hibernating) {
 		g_game.removeCreatureCheck(this);
+	} else {
+		g_game.addCreatureCheck(this);
+	}
+}
+
+void Monster::wakeUp()
+{
+	if (hibernating) {
+		hibernating = false;
+		g_game.addCreatureCheck(this);
 	}
 }
 
+bool Monster::canHibernate() const
+{
+	// conditions have to run out on time and a think script expects to be called
+	if (mType->info.thinkEvent != -1) {
+		return false;
+	}
+
+	if (std::any_of(conditions.begin(), conditions.end(),
+	                [](const Condition* condition) { return condition->getTicks() != -1; })) {
+		return false;
+	}
+	return !g_game.map.hasPlayersInRange(getPosition(), ACTIVATION_RANGE_X, ACTIVATION_RANGE_Y);
+}
+
 void Monster::updateIdleStatus()
 {
 	bool idle = false;
@@ -832,18 +880,23 @@ void Monster::doAttacking(uint32_t interval)
 bool Monster::canUseAttack(const Position& pos, const Creature* target) const
 {
 	if (isHostile()) {
-		const Position& targetPos = target->getPosition();
-		uint32_t distance = std::max<uint32_t>(pos.getDistanceX(targetPos), pos.getDistanceY(targetPos));
-		for (const spellBlock_t& spellBlock : mType->info.attackSpells) {
-			if (spellBlock.range != 0 && distance <= spellBlock.range) {
-				return g_game.isSightClear(pos, targetPos, true);
-			}
-		}
-		return false;
+		return hasAttackInRange(pos, target) && g_game.isSightClear(pos, target->getPosition(), true);
 	}
 	return true;
 }
 
+bool Monster::hasAttackInRange(const Position& pos, const Creature* target) const
+{
+	const Position& targetPos = target->getPosition();
+	uint32_t distance = std::max<uint32_t>(pos.getDistanceX(targetPos), pos.getDistanceY(targetPos));
+	for (const spellBlock_t& spellBlock : mType->info.attackSpells) {
+		if (spellBlock.range != 0 && distance <= spellBlock.range) {
+			return true;
+		}
+	}
+	return false;
+}
+
 bool Monster::canUseSpell(const Position& pos, const Position& targetPos, const spellBlock_t& sb, uint32_t interval,
                           bool& inRange, bool& resetTicks)
 {
@@ -127,8 +127,15 @@ public:
 
 	bool isInSpawnRange(const Position& pos) const;
 
+	// idle monsters hibernate, out of the creature checks, while no player is within this range
+	static constexpr int32_t ACTIVATION_RANGE_X = Map::maxViewportX;
+	static constexpr int32_t ACTIVATION_RANGE_Y = Map::maxViewportY;
+
 	bool getIdleStatus() const { return isIdle; }
 	void setIdle(bool idle);
+	bool isHibernating() const { return hibernating; }
+	// puts a hibernating monster back into the creature checks, its next think decides whether it stays awake
+	void wakeUp();
 
 	bool isFriend(const Creature* creature) const;
 	bool isOpponent(const Creature* creature) const;
@@ -182,6 +189,7 @@ private:
 
 	bool ignoreFieldDamage = false;
 	bool isIdle = true;
+	bool hibernating = false;
 	bool isMasterInRange = false;
 	bool randomStepping = false;
 	bool walkingToSpawn = false;
@@ -195,8 +203,10 @@ private:
 	void clearTargetList();
 	void clearFriendList();
 	void updateIdleStatus();
+	bool canHibernate() const;
 
 	bool canUseAttack(const Position& pos, const Creature* target) const;
+	bool hasAttackInRange(const Position& pos, const Creature* target) const;
 	bool canUseSpell(const Position& pos, const Position& targetPos, const spellBlock_t& sb, uint32_t interval,
 	                 bool& inRange, bool& resetTicks);
 	bool getRandomStep(const Position& creaturePos, Direction& direction) const;
@@ -7,12 +7,6 @@
 extern Game g_game;
 extern Scheduler g_scheduler;
 
-// Define createSchedulerTask with proper TaskFunc signature
-SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f)
-{
-    return new SchedulerTask(delay, std::move(f));
-}
-
 void Monster::onAttackedCreatureKilled(Creature* target)
 {
     if (target == this) {
@@ -36,11 +36,13 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <bitset>
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 #include <boost/asio/ip/address_v4.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <boost/lockfree/stack.hpp>
 #include <boost/variant.hpp>
 #include <cassert>
@@ -75,6 +77,7 @@
 #include <optional>
 #include <random>
 #include <set>
+#include <source_location>
 #include <sstream>
 #include <string>
 #include <string_view>
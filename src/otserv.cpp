@@ -17,6 +17,8 @@
 #include "script.h"
 #include "scriptmanager.h"
 #include "server.h"
+#include "taskstats.h"
+#include "workerpool.h"
 
 #include <fmt/format.h>
 #include <fstream>
@@ -27,6 +29,7 @@
 DatabaseTasks g_databaseTasks;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
+WorkerPool g_workerPool;
 
 Game g_game;
 Monsters g_monsters;
@@ -88,6 +91,15 @@ void mainLoader(ServiceManager* services)
 		return;
 	}
 
+	TaskStatistics::setEnabled(getBoolean(ConfigManager::TASK_STATISTICS));
+
+	// -1 uses every core, the dispatcher counts as one of them
+	int64_t workerThreads = getInteger(ConfigManager::WORKER_THREADS);
+	if (workerThreads < 0) {
+		workerThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+	g_workerPool.start(workerThreads);
+
 #ifdef _WIN32
 	auto defaultPriority = getString(ConfigManager::DEFAULT_PRIORITY);
 	if (caseInsensitiveEqual(defaultPriority, "high")) {
@@ -208,6 +220,13 @@ void mainLoader(ServiceManager* services)
 	std::cout << ">> Initializing gamestate" << std::endl;
 	g_game.setGameState(GAME_STATE_INIT);
 
+	// -1 runs one io_context per core
+	int64_t networkThreads = getInteger(ConfigManager::NETWORK_THREADS);
+	if (networkThreads < 0) {
+		networkThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	services->setThreadCount(std::max<int64_t>(networkThreads, 1));
+
 	// Game client protocols
 	services->add<ProtocolGame>(static_cast<uint16_t>(getInteger(ConfigManager::GAME_PORT)));
 	services->add<ProtocolLogin>(static_cast<uint16_t>(getInteger(ConfigManager::LOGIN_PORT)));
@@ -282,6 +301,7 @@ void startServer()
 		g_scheduler.shutdown();
 		g_databaseTasks.shutdown();
 		g_dispatcher.shutdown();
+		g_workerPool.shutdown();
 	}
 
 	g_scheduler.join();
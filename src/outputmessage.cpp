@@ -24,15 +24,20 @@ void scheduleSendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
 	    createSchedulerTask(OUTPUTMESSAGE_AUTOSEND_DELAY.count(), [&]() { sendAll(bufferedProtocols); }));
 }
 
-void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
+void sendBuffers(const std::vector<Protocol_ptr>& bufferedProtocols)
 {
-	// dispatcher thread
 	for (auto& protocol : bufferedProtocols) {
 		auto& msg = protocol->getCurrentBuffer();
 		if (msg) {
 			protocol->send(std::move(msg));
 		}
 	}
+}
+
+void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
+{
+	// dispatcher thread
+	sendBuffers(bufferedProtocols);
 
 	if (!bufferedProtocols.empty()) {
 		scheduleSendAll(bufferedProtocols);
@@ -44,12 +49,18 @@ void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
 void OutputMessagePool::addProtocolToAutosend(Protocol_ptr protocol)
 {
 	// dispatcher thread
-	if (bufferedProtocols.empty()) {
+	if (autosendTimer && bufferedProtocols.empty()) {
 		scheduleSendAll(bufferedProtocols);
 	}
 	bufferedProtocols.emplace_back(protocol);
 }
 
+void OutputMessagePool::sendAll()
+{
+	// dispatcher thread
+	sendBuffers(bufferedProtocols);
+}
+
 void OutputMessagePool::removeProtocolFromAutosend(const Protocol_ptr& protocol)
 {
 	// dispatcher thread
@@ -11,6 +11,9 @@
 class OutputMessage : public NetworkMessage
 {
 public:
+	static constexpr MsgSize_t COMPRESSED_FLAG = 0x8000;
+	static_assert(NETWORKMESSAGE_MAXSIZE <= COMPRESSED_FLAG, "message lengths need the highest bit for the flag");
+
 	OutputMessage() = default;
 
 	// non-copyable
@@ -19,7 +22,20 @@ public:
 
 	uint8_t* getOutputBuffer() { return &buffer[outputBufferStart]; }
 
-	void writeMessageLength() { add_header(info.length); }
+	// the client inflates bodies whose length has COMPRESSED_FLAG set
+	void writeMessageLength(bool compressed = false)
+	{
+		add_header(static_cast<MsgSize_t>(compressed ? info.length | COMPRESSED_FLAG : info.length));
+	}
+
+	// only before the first header is added
+	void setBody(const uint8_t* data, MsgSize_t length)
+	{
+		assert(outputBufferStart == INITIAL_BUFFER_POSITION);
+		std::memcpy(&buffer[outputBufferStart], data, length);
+		info.length = length;
+		info.position = outputBufferStart + length;
+	}
 
 	void addCryptoHeader(const bool addChecksum)
 	{
@@ -78,11 +94,16 @@ public:
 	void addProtocolToAutosend(Protocol_ptr protocol);
 	void removeProtocolFromAutosend(const Protocol_ptr& protocol);
 
+	// Without the timer buffered messages are only sent by sendAll, the fixed tick game loop calls it once per tick.
+	void setAutosendTimer(bool enabled) { autosendTimer = enabled; }
+	void sendAll();
+
 private:
 	OutputMessagePool() = default;
 	// NOTE: A vector is used here because this container is mostly read and relatively rarely modified (only when a
 	// client connects/disconnects)
 	std::vector<Protocol_ptr> bufferedProtocols;
+	bool autosendTimer = true;
 };
 
 #endif // FS_OUTPUTMESSAGE_H
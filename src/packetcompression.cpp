@@ -0,0 +1,77 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "packetcompression.h"
+
+#include "outputmessage.h"
+
+#include <zlib.h>
+
+namespace {
+
+// bytes a Z_SYNC_FLUSH adds on top of deflateBound
+constexpr size_t SYNC_FLUSH_LENGTH = 6;
+
+} // namespace
+
+PacketCompression::PacketCompression(size_t threshold) : stream(std::make_unique<z_stream>()), threshold(threshold) {}
+
+PacketCompression::~PacketCompression()
+{
+	if (initialized) {
+		deflateEnd(stream.get());
+	}
+}
+
+bool PacketCompression::init(int32_t level)
+{
+	initialized = deflateInit2(stream.get(), level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+	return initialized;
+}
+
+bool PacketCompression::compress(OutputMessage& msg)
+{
+	const size_t length = msg.getLength();
+	if (failed || length < threshold) {
+		return false;
+	}
+
+	// once a body went into the stream the client needs it, so only bodies that are sure to fit
+	if (deflateBound(stream.get(), length) + SYNC_FLUSH_LENGTH > MAX_COMPRESSED_LENGTH) {
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	thread_local std::array<uint8_t, MAX_COMPRESSED_LENGTH> compressed;
+	stream->next_in = msg.getOutputBuffer();
+	stream->avail_in = length;
+	stream->next_out = compressed.data();
+	stream->avail_out = compressed.size();
+	if (deflate(stream.get(), Z_SYNC_FLUSH) != Z_OK || stream->avail_in != 0) {
+		failed = true;
+		throw std::runtime_error(stream->msg ? stream->msg : "deflate failed");
+	}
+
+	const size_t compressedLength = compressed.size() - stream->avail_out;
+	msg.setBody(compressed.data(), compressedLength);
+
+	const auto duration = std::chrono::steady_clock::now() - start;
+	messages.fetch_add(1, std::memory_order_relaxed);
+	bytesIn.fetch_add(length, std::memory_order_relaxed);
+	bytesOut.fetch_add(compressedLength, std::memory_order_relaxed);
+	time.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+	return true;
+}
+
+CompressionStats PacketCompression::getStats() const
+{
+	CompressionStats stats;
+	stats.messages = messages.load(std::memory_order_relaxed);
+	stats.bytesIn = bytesIn.load(std::memory_order_relaxed);
+	stats.bytesOut = bytesOut.load(std::memory_order_relaxed);
+	stats.time = std::chrono::nanoseconds(time.load(std::memory_order_relaxed));
+	return stats;
+}
@@ -0,0 +1,61 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PACKETCOMPRESSION_H
+#define FS_PACKETCOMPRESSION_H
+
+#include "networkmessage.h"
+
+class OutputMessage;
+struct z_stream_s;
+
+struct CompressionStats
+{
+	uint64_t messages = 0;
+	// message bodies before and after deflate
+	uint64_t bytesIn = 0;
+	uint64_t bytesOut = 0;
+	std::chrono::nanoseconds time{0};
+};
+
+/**
+ * One raw deflate stream for everything sent on a connection, each compressed body ends with a sync flush.
+ * The client inflates them with one stream as well, so later messages refer back to earlier ones and the small
+ * updates that repeat most of the previous packet compress much better than on their own.
+ */
+class PacketCompression
+{
+public:
+	// room for a deflated body, what is left of the buffer after the headers and the XTEA padding
+	static constexpr size_t MAX_COMPRESSED_LENGTH =
+	    NetworkMessage::MAX_BODY_LENGTH - NetworkMessage::INITIAL_BUFFER_POSITION - NetworkMessage::XTEA_MULTIPLE;
+
+	explicit PacketCompression(size_t threshold);
+	~PacketCompression();
+
+	// non-copyable
+	PacketCompression(const PacketCompression&) = delete;
+	PacketCompression& operator=(const PacketCompression&) = delete;
+
+	bool init(int32_t level);
+
+	// connection strand, returns whether the body of msg was replaced by its deflated form and throws a
+	// std::runtime_error if deflate fails, the stream can not be used anymore after that
+	bool compress(OutputMessage& msg);
+
+	// any thread
+	CompressionStats getStats() const;
+
+private:
+	std::unique_ptr<z_stream_s> stream;
+	const size_t threshold;
+	bool initialized = false;
+	bool failed = false;
+
+	std::atomic<uint64_t> messages{0};
+	std::atomic<uint64_t> bytesIn{0};
+	std::atomic<uint64_t> bytesOut{0};
+	std::atomic<int64_t> time{0};
+};
+
+#endif // FS_PACKETCOMPRESSION_H
@@ -0,0 +1,391 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "pathgraph.h"
+
+#include "map.h"
+#include "tile.h"
+
+#include <queue>
+
+static_assert(PathGraph::CLUSTER_SIZE == SECTOR_SIZE, "path graph clusters must match the map sectors");
+
+namespace {
+
+constexpr int32_t CLUSTER_CELLS = PathGraph::CLUSTER_SIZE * PathGraph::CLUSTER_SIZE;
+constexpr int32_t UNREACHABLE = std::numeric_limits<int32_t>::max();
+constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+// border runs at least this long get an entrance at both ends instead of one in the middle
+constexpr int32_t SPLIT_ENTRANCE_LENGTH = 6;
+
+// upper bound of entrances expanded by a single search, keeps the cost of a query predictable
+constexpr size_t MAX_EXPANDED_ENTRANCES = 4096;
+
+using DistanceGrid = std::array<int32_t, CLUSTER_CELLS>;
+
+int32_t getCell(int32_t x, int32_t y) { return x * PathGraph::CLUSTER_SIZE + y; }
+
+uint32_t getPositionKey(uint16_t x, uint16_t y) { return (static_cast<uint32_t>(x) << 16) | y; }
+
+int32_t getHeuristic(uint16_t x, uint16_t y, const Position& targetPos)
+{
+	// a diagonal step costs more than two straight ones, so this never overestimates
+	return MAP_NORMALWALKCOST * (std::abs(x - targetPos.x) + std::abs(y - targetPos.y));
+}
+
+/**
+ * Walking cost from the given local position to every tile of the cluster,
+ * using the same step costs as Map::getPathMatching.
+ */
+void computeDistances(const std::array<uint16_t, PathGraph::CLUSTER_SIZE>& walkable, int32_t x, int32_t y,
+                      DistanceGrid& distances)
+{
+	distances.fill(UNREACHABLE);
+
+	using QueueEntry = std::pair<int32_t, int32_t>;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+
+	distances[getCell(x, y)] = 0;
+	queue.emplace(0, getCell(x, y));
+
+	while (!queue.empty()) {
+		const auto [distance, cell] = queue.top();
+		queue.pop();
+
+		if (distance != distances[cell]) {
+			continue;
+		}
+
+		const int32_t cellX = cell / PathGraph::CLUSTER_SIZE;
+		const int32_t cellY = cell % PathGraph::CLUSTER_SIZE;
+		for (int32_t dx = -1; dx <= 1; ++dx) {
+			const int32_t nextX = cellX + dx;
+			if (nextX < 0 || nextX >= PathGraph::CLUSTER_SIZE) {
+				continue;
+			}
+
+			for (int32_t dy = -1; dy <= 1; ++dy) {
+				const int32_t nextY = cellY + dy;
+				if ((dx == 0 && dy == 0) || nextY < 0 || nextY >= PathGraph::CLUSTER_SIZE ||
+				    !hasBitSet(1 << nextY, walkable[nextX])) {
+					continue;
+				}
+
+				const int32_t nextDistance =
+				    distance + (dx != 0 && dy != 0 ? MAP_DIAGONALWALKCOST : MAP_NORMALWALKCOST);
+				const int32_t nextCell = getCell(nextX, nextY);
+				if (nextDistance < distances[nextCell]) {
+					distances[nextCell] = nextDistance;
+					queue.emplace(nextDistance, nextCell);
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+bool PathGraph::isWalkable(const Tile* tile)
+{
+	return tile && tile->getGround() &&
+	       !tile->hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID | TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT);
+}
+
+int32_t PathGraph::Cluster::getEntranceIndex(uint8_t x, uint8_t y) const
+{
+	for (size_t i = 0, size = entrances.size(); i < size; ++i) {
+		if (entrances[i].x == x && entrances[i].y == y) {
+			return static_cast<int32_t>(i);
+		}
+	}
+	return -1;
+}
+
+PathGraph::Cluster& PathGraph::getCluster(const Map& map, uint16_t x, uint16_t y, uint8_t z)
+{
+	const uint32_t key = getClusterKey(x, y, z);
+	{
+		std::shared_lock lock(clustersLock);
+		auto it = clusters.find(key);
+		if (it != clusters.end()) {
+			it->second.lastUsed.store(generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return it->second;
+		}
+	}
+
+	std::unique_lock lock(clustersLock);
+	auto [it, inserted] = clusters.try_emplace(key);
+	if (inserted) {
+		buildCluster(map, it->second, x & ~SECTOR_MASK, y & ~SECTOR_MASK, z);
+	}
+	it->second.lastUsed.store(generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return it->second;
+}
+
+void PathGraph::buildCluster(const Map& map, Cluster& cluster, uint16_t baseX, uint16_t baseY, uint8_t z)
+{
+	for (int32_t x = 0; x < CLUSTER_SIZE; ++x) {
+		for (int32_t y = 0; y < CLUSTER_SIZE; ++y) {
+			if (isWalkable(map.getTile(baseX + x, baseY + y, z))) {
+				cluster.walkable[x] |= 1 << y;
+			}
+		}
+	}
+
+	auto addEntrance = [&cluster](uint8_t x, uint8_t y, uint8_t border) {
+		int32_t index = cluster.getEntranceIndex(x, y);
+		if (index == -1) {
+			cluster.entrances.push_back({x, y, border});
+		} else {
+			cluster.entrances[index].borders |= border;
+		}
+	};
+
+	// both clusters sharing a border scan the same pairs of tiles in the same
+	// order, so they always agree on where the entrances between them are
+	auto scanBorder = [&](uint8_t border, int32_t fixedX, int32_t fixedY, int32_t stepX, int32_t stepY,
+	                      int32_t acrossX, int32_t acrossY) {
+		auto isOpen = [&](int32_t i) {
+			const int32_t x = fixedX + i * stepX;
+			const int32_t y = fixedY + i * stepY;
+			if (!hasBitSet(1 << y, cluster.walkable[x])) {
+				return false;
+			}
+
+			const int32_t nextX = baseX + x + acrossX;
+			const int32_t nextY = baseY + y + acrossY;
+			if (nextX < 0 || nextX > std::numeric_limits<uint16_t>::max() || nextY < 0 ||
+			    nextY > std::numeric_limits<uint16_t>::max()) {
+				return false;
+			}
+			return isWalkable(map.getTile(nextX, nextY, z));
+		};
+
+		auto addAt = [&](int32_t i) { addEntrance(fixedX + i * stepX, fixedY + i * stepY, border); };
+
+		int32_t runStart = -1;
+		for (int32_t i = 0; i <= CLUSTER_SIZE; ++i) {
+			if (i < CLUSTER_SIZE && isOpen(i)) {
+				if (runStart == -1) {
+					runStart = i;
+				}
+				continue;
+			}
+
+			if (runStart != -1) {
+				const int32_t runEnd = i - 1;
+				if (runEnd - runStart + 1 >= SPLIT_ENTRANCE_LENGTH) {
+					addAt(runStart);
+					addAt(runEnd);
+				} else {
+					addAt((runStart + runEnd) / 2);
+				}
+				runStart = -1;
+			}
+		}
+	};
+
+	scanBorder(BORDER_NORTH, 0, 0, 1, 0, 0, -1);
+	scanBorder(BORDER_EAST, CLUSTER_SIZE - 1, 0, 0, 1, 1, 0);
+	scanBorder(BORDER_SOUTH, 0, CLUSTER_SIZE - 1, 1, 0, 0, 1);
+	scanBorder(BORDER_WEST, 0, 0, 0, 1, -1, 0);
+
+	const size_t count = cluster.entrances.size();
+	cluster.costs.assign(count * count, UNREACHABLE);
+
+	DistanceGrid distances;
+	for (size_t i = 0; i < count; ++i) {
+		computeDistances(cluster.walkable, cluster.entrances[i].x, cluster.entrances[i].y, distances);
+		for (size_t j = 0; j < count; ++j) {
+			cluster.costs[i * count + j] = distances[getCell(cluster.entrances[j].x, cluster.entrances[j].y)];
+		}
+	}
+}
+
+void PathGraph::invalidate(const Position& pos)
+{
+	if (clusters.empty()) {
+		return;
+	}
+
+	clusters.erase(getClusterKey(pos.x, pos.y, pos.z));
+
+	// border tiles also decide where the neighbouring cluster has its entrances
+	const int32_t x = pos.x & SECTOR_MASK;
+	const int32_t y = pos.y & SECTOR_MASK;
+	if (x == 0 && pos.x >= CLUSTER_SIZE) {
+		clusters.erase(getClusterKey(pos.x - 1, pos.y, pos.z));
+	} else if (x == CLUSTER_SIZE - 1 && pos.x < std::numeric_limits<uint16_t>::max()) {
+		clusters.erase(getClusterKey(pos.x + 1, pos.y, pos.z));
+	}
+
+	if (y == 0 && pos.y >= CLUSTER_SIZE) {
+		clusters.erase(getClusterKey(pos.x, pos.y - 1, pos.z));
+	} else if (y == CLUSTER_SIZE - 1 && pos.y < std::numeric_limits<uint16_t>::max()) {
+		clusters.erase(getClusterKey(pos.x, pos.y + 1, pos.z));
+	}
+}
+
+void PathGraph::trim()
+{
+	const uint32_t current = generation.fetch_add(1, std::memory_order_relaxed);
+	if (clusters.size() <= MAX_CLUSTERS) {
+		return;
+	}
+
+	// drop down to three quarters so that the next trims do not have to sort again right away
+	std::vector<std::pair<uint32_t, uint32_t>> ages;
+	ages.reserve(clusters.size());
+	for (const auto& [key, cluster] : clusters) {
+		ages.emplace_back(current - cluster.lastUsed.load(std::memory_order_relaxed), key);
+	}
+
+	const size_t dropCount = clusters.size() - MAX_CLUSTERS * 3 / 4;
+	std::nth_element(ages.begin(), ages.begin() + dropCount, ages.end(), std::greater<>());
+	for (size_t i = 0; i < dropCount; ++i) {
+		clusters.erase(ages[i].second);
+	}
+}
+
+bool PathGraph::findWaypoints(const Map& map, const Position& startPos, const Position& targetPos,
+                              std::vector<Position>& waypoints)
+{
+	waypoints.clear();
+
+	const uint8_t z = startPos.z;
+	const uint32_t startKey = getClusterKey(startPos.x, startPos.y, z);
+	const uint32_t targetKey = getClusterKey(targetPos.x, targetPos.y, z);
+
+	// unordered_map never invalidates references to its elements on insertion
+	const Cluster& startCluster = getCluster(map, startPos.x, startPos.y, z);
+	const Cluster& targetCluster = getCluster(map, targetPos.x, targetPos.y, z);
+
+	DistanceGrid startDistances;
+	computeDistances(startCluster.walkable, startPos.x & SECTOR_MASK, startPos.y & SECTOR_MASK, startDistances);
+
+	DistanceGrid targetDistances;
+	computeDistances(targetCluster.walkable, targetPos.x & SECTOR_MASK, targetPos.y & SECTOR_MASK, targetDistances);
+
+	int32_t bestCost = UNREACHABLE;
+	uint32_t bestParent = NO_PARENT;
+	if (startKey == targetKey) {
+		bestCost = startDistances[getCell(targetPos.x & SECTOR_MASK, targetPos.y & SECTOR_MASK)];
+	}
+
+	struct SearchNode
+	{
+		int32_t g;
+		uint32_t parent;
+		uint32_t clusterKey;
+		// taken from getCluster when the node is relaxed, other workers may insert into clusters meanwhile
+		const Cluster* cluster;
+		uint16_t entrance;
+		bool closed;
+	};
+	std::unordered_map<uint32_t, SearchNode> nodes;
+
+	using OpenEntry = std::pair<int32_t, uint32_t>;
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<>> openList;
+
+	auto relax = [&](uint16_t x, uint16_t y, uint32_t clusterKey, const Cluster& cluster, size_t entrance, int32_t g,
+	                 uint32_t parent) {
+		const uint32_t key = getPositionKey(x, y);
+		auto [it, inserted] = nodes.try_emplace(
+		    key, SearchNode{g, parent, clusterKey, &cluster, static_cast<uint16_t>(entrance), false});
+		if (!inserted) {
+			SearchNode& node = it->second;
+			if (node.closed || node.g <= g) {
+				return;
+			}
+			node.g = g;
+			node.parent = parent;
+		}
+		openList.emplace(g + getHeuristic(x, y, targetPos), key);
+	};
+
+	const uint16_t startBaseX = startPos.x & ~SECTOR_MASK;
+	const uint16_t startBaseY = startPos.y & ~SECTOR_MASK;
+	for (size_t i = 0, size = startCluster.entrances.size(); i < size; ++i) {
+		const Entrance& entrance = startCluster.entrances[i];
+		const int32_t distance = startDistances[getCell(entrance.x, entrance.y)];
+		if (distance != UNREACHABLE) {
+			relax(startBaseX + entrance.x, startBaseY + entrance.y, startKey, startCluster, i, distance, NO_PARENT);
+		}
+	}
+
+	size_t expanded = 0;
+	while (!openList.empty()) {
+		const auto [f, key] = openList.top();
+		openList.pop();
+
+		if (f >= bestCost) {
+			break;
+		}
+
+		SearchNode& node = nodes.find(key)->second;
+		const uint16_t x = key >> 16;
+		const uint16_t y = key & 0xFFFF;
+		if (node.closed || f != node.g + getHeuristic(x, y, targetPos)) {
+			continue;
+		}
+
+		if (++expanded > MAX_EXPANDED_ENTRANCES) {
+			return false;
+		}
+		node.closed = true;
+
+		const int32_t g = node.g;
+		const uint32_t clusterKey = node.clusterKey;
+		const Cluster& cluster = *node.cluster;
+		const size_t index = node.entrance;
+		const uint16_t baseX = x & ~SECTOR_MASK;
+		const uint16_t baseY = y & ~SECTOR_MASK;
+
+		if (clusterKey == targetKey) {
+			const int32_t distance = targetDistances[getCell(x & SECTOR_MASK, y & SECTOR_MASK)];
+			if (distance != UNREACHABLE && g + distance < bestCost) {
+				bestCost = g + distance;
+				bestParent = key;
+			}
+		}
+
+		const size_t count = cluster.entrances.size();
+		for (size_t i = 0; i < count; ++i) {
+			const int32_t cost = cluster.costs[index * count + i];
+			if (i != index && cost != UNREACHABLE) {
+				const Entrance& entrance = cluster.entrances[i];
+				relax(baseX + entrance.x, baseY + entrance.y, clusterKey, cluster, i, g + cost, key);
+			}
+		}
+
+		const uint8_t borders = cluster.entrances[index].borders;
+		for (const auto& [border, dx, dy] : {std::tuple{BORDER_NORTH, 0, -1}, std::tuple{BORDER_EAST, 1, 0},
+		                                     std::tuple{BORDER_SOUTH, 0, 1}, std::tuple{BORDER_WEST, -1, 0}}) {
+			if (!hasBitSet(border, borders)) {
+				continue;
+			}
+
+			const uint16_t nextX = x + dx;
+			const uint16_t nextY = y + dy;
+			const Cluster& nextCluster = getCluster(map, nextX, nextY, z);
+			const int32_t nextIndex = nextCluster.getEntranceIndex(nextX & SECTOR_MASK, nextY & SECTOR_MASK);
+			if (nextIndex != -1) {
+				relax(nextX, nextY, getClusterKey(nextX, nextY, z), nextCluster, nextIndex, g + MAP_NORMALWALKCOST,
+				      key);
+			}
+		}
+	}
+
+	if (bestCost == UNREACHABLE) {
+		return false;
+	}
+
+	for (uint32_t key = bestParent; key != NO_PARENT; key = nodes.find(key)->second.parent) {
+		waypoints.emplace_back(key >> 16, key & 0xFFFF, z);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	return true;
+}
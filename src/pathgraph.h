@@ -0,0 +1,111 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PATHGRAPH_H
+#define FS_PATHGRAPH_H
+
+#include "position.h"
+
+#include <shared_mutex>
+
+class Map;
+class Tile;
+
+/**
+ * Abstract graph for hierarchical (HPA*) path finding.
+ * Every floor of a map sector is a cluster whose nodes are the entrances on
+ * its borders, connected by the precomputed walking costs between them.
+ * Clusters are built on first use and dropped again whenever a tile on or
+ * next to them changes whether it can be walked on at all, or when they are
+ * among the least recently used ones once there are more than MAX_CLUSTERS.
+ * Searches may run on several threads at once as long as the map is not
+ * modified meanwhile, see Game::planFollowPaths.
+ */
+class PathGraph
+{
+public:
+	static constexpr int32_t CLUSTER_SIZE = 16;
+	// a cluster takes a few hundred bytes, so this keeps the graph at a few megabytes
+	static constexpr size_t MAX_CLUSTERS = 16384;
+
+	PathGraph() = default;
+
+	// non-copyable
+	PathGraph(const PathGraph&) = delete;
+	PathGraph& operator=(const PathGraph&) = delete;
+
+	/**
+	 * Finds the cluster entrances a path from startPos to targetPos passes through.
+	 * \param waypoints receives the entrances in walking order, empty if the
+	 * path never leaves the cluster of startPos
+	 * \returns false if the graph does not connect both positions within its
+	 * search budget
+	 */
+	bool findWaypoints(const Map& map, const Position& startPos, const Position& targetPos,
+	                   std::vector<Position>& waypoints);
+
+	/**
+	 * Drops every cluster whose entrances depend on the tile at pos.
+	 * Must be called whenever a tile changes whether it is walkable, on the
+	 * dispatcher while no worker jobs are in flight.
+	 */
+	void invalidate(const Position& pos);
+
+	/**
+	 * Starts a new generation and drops the clusters used longest ago while
+	 * there are more than MAX_CLUSTERS. Dispatcher thread only, while no
+	 * worker jobs are in flight, as searches keep pointers to clusters.
+	 */
+	void trim();
+
+	size_t getClusterCount() const { return clusters.size(); }
+
+	/**
+	 * Whether any creature could ever stand on the tile, ignoring creatures,
+	 * fields and movable items that only block some of them.
+	 */
+	static bool isWalkable(const Tile* tile);
+
+private:
+	enum Border : uint8_t
+	{
+		BORDER_NORTH = 1 << 0,
+		BORDER_EAST = 1 << 1,
+		BORDER_SOUTH = 1 << 2,
+		BORDER_WEST = 1 << 3,
+	};
+
+	struct Entrance
+	{
+		uint8_t x, y;
+		uint8_t borders;
+	};
+
+	struct Cluster
+	{
+		// bit y of column x is set if that tile is walkable
+		std::array<uint16_t, CLUSTER_SIZE> walkable = {};
+		std::vector<Entrance> entrances;
+		// walking cost between each pair of entrances, row-major
+		std::vector<int32_t> costs;
+		// generation of the last search that used this cluster
+		std::atomic<uint32_t> lastUsed{0};
+
+		int32_t getEntranceIndex(uint8_t x, uint8_t y) const;
+	};
+
+	Cluster& getCluster(const Map& map, uint16_t x, uint16_t y, uint8_t z);
+	static void buildCluster(const Map& map, Cluster& cluster, uint16_t baseX, uint16_t baseY, uint8_t z);
+
+	static uint32_t getClusterKey(uint16_t x, uint16_t y, uint8_t z)
+	{
+		return (((static_cast<uint32_t>(x) / CLUSTER_SIZE) << 16) | (y / CLUSTER_SIZE)) << 4 | z;
+	}
+
+	// only touched through getCluster while searches run, invalidate and trim erase without the lock
+	std::unordered_map<uint32_t, Cluster> clusters;
+	std::shared_mutex clustersLock;
+	std::atomic<uint32_t> generation{0};
+};
+
+#endif // FS_PATHGRAPH_H
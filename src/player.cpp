@@ -1176,7 +1176,7 @@ void Player::onCreatureMove(Creature* creature, const Tile* newTile, const Posit
 
 	if (hasFollowPath && (creature == followCreature || (creature == this && followCreature))) {
 		isUpdatingPath = false;
-		g_dispatcher.addTask([id = getID()]() { g_game.updateCreatureWalk(id); });
+		g_dispatcher.addTask([id = getID()]() { g_game.updateCreatureWalk(id); }, {TASK_CATEGORY_PATHFINDING});
 	}
 
 	if (creature != this) {
@@ -1872,6 +1872,15 @@ uint32_t Player::getIP() const
 	return 0;
 }
 
+CompressionStats Player::getCompressionStats() const
+{
+	if (client) {
+		return client->getCompressionStats();
+	}
+
+	return {};
+}
+
 void Player::death(Creature* lastHitCreature)
 {
 	loginPosition = town->getTemplePosition();
@@ -3090,7 +3099,7 @@ bool Player::setAttackedCreature(Creature* creature)
 	}
 
 	if (creature) {
-		g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); });
+		g_dispatcher.addTask([id = getID()]() { g_game.checkCreatureAttack(id); }, {TASK_CATEGORY_CREATURE});
 	}
 	return true;
 }
@@ -3147,7 +3156,8 @@ void Player::doAttacking(uint32_t)
 		}
 
 		SchedulerTask* task = createSchedulerTask(std::max<uint32_t>(SCHEDULER_MINTICKS, delay),
-		                                          [id = getID()]() { g_game.checkCreatureAttack(id); });
+		                                          [id = getID()]() { g_game.checkCreatureAttack(id); },
+		                                          {TASK_CATEGORY_CREATURE});
 
 		if (!classicSpeed) {
 			setNextActionTask(task, false);
@@ -4464,8 +4474,7 @@ void Player::sendPendingUpdates()
         }
     }
     
-    // Send via the network thread instead of directly
-    g_game.enqueueNetworkUpdate(this, std::move(msg));
+    sendNetworkMessage(msg);
     
     pendingUpdates.clear();
 }
@@ -284,6 +284,7 @@ public:
 		}
 	}
 	uint32_t getIP() const;
+	CompressionStats getCompressionStats() const;
 	uint32_t getLastIP() const { return lastIP; }
 
 	void addContainer(uint8_t cid, Container* container);
@@ -836,6 +837,12 @@ public:
 			client->sendMagicEffect(pos, type);
 		}
 	}
+	void sendEffectMessage(const NetworkMessage& message, const Position* pos = nullptr) const
+	{
+		if (client) {
+			client->sendEffectMessage(message, pos);
+		}
+	}
 	void sendPing();
 	void sendStats();
 	void sendSkills() const
@@ -45,10 +45,29 @@ bool XTEA_decrypt(NetworkMessage& msg, const xtea::round_keys& key)
 
 } // namespace
 
-void Protocol::onSendMessage(const OutputMessage_ptr& msg) const
+Protocol::Protocol(Connection_ptr connection) : connection(connection) {}
+
+Protocol::~Protocol() = default;
+
+void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 {
 	if (!rawMessages) {
-		msg->writeMessageLength();
+		bool compressed = false;
+		if (compression) {
+			try {
+				compressed = compression->compress(*msg);
+			} catch (const std::runtime_error& e) {
+				// the client can not inflate anything that follows, we are on the strand so this closes the socket
+				// before msg is written
+				std::cout << "[Network error - Protocol::onSendMessage] " << e.what() << std::endl;
+				if (auto connection = getConnection()) {
+					connection->close(Connection::FORCE_CLOSE);
+				}
+				return;
+			}
+		}
+
+		msg->writeMessageLength(compressed);
 
 		if (encryptionEnabled) {
 			XTEA_encrypt(*msg, key);
@@ -78,6 +97,25 @@ OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 	return outputBuffer;
 }
 
+bool Protocol::enableCompression(int32_t level, size_t threshold)
+{
+	auto newCompression = std::make_unique<PacketCompression>(threshold);
+	if (!newCompression->init(level)) {
+		return false;
+	}
+
+	compression = std::move(newCompression);
+	return true;
+}
+
+CompressionStats Protocol::getCompressionStats() const
+{
+	if (compression) {
+		return compression->getStats();
+	}
+	return {};
+}
+
 bool Protocol::RSA_decrypt(NetworkMessage& msg)
 {
 	if ((msg.getLength() - msg.getBufferPosition()) != 128) {
@@ -5,13 +5,14 @@
 #define FS_PROTOCOL_H
 
 #include "connection.h"
+#include "packetcompression.h"
 #include "xtea.h"
 
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
 public:
-	explicit Protocol(Connection_ptr connection) : connection(connection) {}
-	virtual ~Protocol() = default;
+	explicit Protocol(Connection_ptr connection);
+	virtual ~Protocol();
 
 	// non-copyable
 	Protocol(const Protocol&) = delete;
@@ -19,7 +20,7 @@ public:
 
 	virtual void parsePacket(NetworkMessage&) {}
 
-	virtual void onSendMessage(const OutputMessage_ptr& msg) const;
+	virtual void onSendMessage(const OutputMessage_ptr& msg);
 	void onRecvMessage(NetworkMessage& msg);
 	virtual void onRecvFirstMessage(NetworkMessage& msg) = 0;
 	virtual void onConnect() {}
@@ -31,11 +32,21 @@ public:
 	uint32_t getIP() const;
 	uint32_t getIP(std::string_view s) const;
 
+	// any thread, all zero until compression is enabled
+	CompressionStats getCompressionStats() const;
+
 	// Use this function for autosend messages only
 	OutputMessage_ptr getOutputBuffer(int32_t size);
 
 	OutputMessage_ptr& getCurrentBuffer() { return outputBuffer; }
 
+	// dispatcher thread, whether the client is too far behind for messages it can do without
+	bool isSendBacklogged() const
+	{
+		auto connection = getConnection();
+		return connection && connection->getSendBacklog() >= CONNECTION_SEND_BACKLOG;
+	}
+
 	void send(OutputMessage_ptr msg) const
 	{
 		if (auto connection = getConnection()) {
@@ -53,6 +64,9 @@ protected:
 	void enableXTEAEncryption() { encryptionEnabled = true; }
 	void setXTEAKey(const xtea::key& key) { this->key = xtea::expand_key(key); }
 	void disableChecksum() { checksumEnabled = false; }
+	// network thread, bodies of at least threshold bytes are deflated from now on
+	bool enableCompression(int32_t level, size_t threshold);
+	bool isCompressionEnabled() const { return compression != nullptr; }
 
 	static bool RSA_decrypt(NetworkMessage& msg);
 
@@ -64,6 +78,7 @@ private:
 	friend class Connection;
 
 	OutputMessage_ptr outputBuffer;
+	std::unique_ptr<PacketCompression> compression;
 
 	const ConnectionWeak_ptr connection;
 	xtea::round_keys key;
@@ -114,6 +114,65 @@ std::size_t clientLogin(const Player& player)
 	return currentSlot;
 }
 
+// rebuilds the cached item description of tile if its items or the item types changed since, dispatcher thread only
+const TileItemsDescription& getItemsDescription(const Tile* tile, bool isOTCv8)
+{
+	TileItemsDescription& description = tile->getItemsDescription(isOTCv8);
+	if (description.version == tile->getItemsVersion() &&
+	    description.itemsGeneration == Item::items.getGeneration()) {
+		return description;
+	}
+
+	static NetworkMessage scratch;
+	scratch.reset();
+
+	description.thingCount = 0;
+	auto addThing = [&](const Item* item) {
+		scratch.addItem(item, isOTCv8);
+		description.ends[description.thingCount++] =
+		    static_cast<uint16_t>(scratch.getBufferPosition() - NetworkMessage::INITIAL_BUFFER_POSITION);
+	};
+
+	if (const Item* ground = tile->getGround()) {
+		addThing(ground);
+	}
+
+	const TileItemVector* items = tile->getItemList();
+	if (items) {
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem();
+		     it != end && description.thingCount < MAX_STACKPOS_THINGS; ++it) {
+			addThing(*it);
+		}
+	}
+
+	description.topCount = description.thingCount;
+
+	if (items) {
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem();
+		     it != end && description.thingCount < MAX_STACKPOS_THINGS; ++it) {
+			addThing(*it);
+		}
+	}
+
+	const uint8_t* bytes = scratch.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	const size_t length = description.thingCount != 0 ? description.ends[description.thingCount - 1] : 0;
+	description.bytes.assign(bytes, bytes + length);
+	description.version = tile->getItemsVersion();
+	description.itemsGeneration = Item::items.getGeneration();
+	return description;
+}
+
+// copies the things [first, last) of description into msg
+void addItemsDescription(NetworkMessage& msg, const TileItemsDescription& description, size_t first, size_t last)
+{
+	if (first >= last) {
+		return;
+	}
+
+	size_t begin = first != 0 ? description.ends[first - 1] : 0;
+	msg.addBytes(reinterpret_cast<const char*>(description.bytes.data() + begin), description.ends[last - 1] - begin);
+}
+
 } // namespace
 
 // Helper struct for automatic player cleanup
@@ -406,6 +465,16 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 	const auto otcv8StrLen = msg.get<uint16_t>();
 	if (otcv8StrLen == OTCV8_LENGTH && msg.getString(OTCV8_LENGTH) == OTCV8_NAME) {
 		isOTCv8 = msg.get<uint16_t>() != 0;
+
+		const int64_t compressionLevel = getInteger(ConfigManager::PACKET_COMPRESSION_LEVEL);
+		if (isOTCv8) {
+			otcv8Features = msg.get<uint16_t>();
+		}
+
+		if ((otcv8Features & OTCV8_FEATURE_COMPRESSION) && compressionLevel > 0) {
+			enableCompression(std::min<int64_t>(compressionLevel, 9),
+			                  std::max<int64_t>(getInteger(ConfigManager::PACKET_COMPRESSION_THRESHOLD), 0));
+		}
 	}
 
 	if (isOTCv8) {
@@ -790,29 +859,20 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 }
 void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage& msg)
 {
-	int32_t count = 0;
-	if (const auto ground = tile->getGround()) {
-		msg.addItem(ground, isOTCv8);
-		++count;
-	}
+	// ground and items are encoded once per change of the tile, only the creatures are added per client
+	const TileItemsDescription& description = getItemsDescription(tile, isOTCv8);
 
 	const bool isStacked = player->getPosition() == tile->getPosition();
 
-	const TileItemVector* items = tile->getItemList();
-	if (items) {
-		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
-			msg.addItem(*it, isOTCv8);
+	int32_t count = description.topCount;
+	if (!isOTCv8 && isStacked) {
+		// the player always takes the place after the ninth thing on its own tile
+		count = std::min(count, 9);
+	}
 
-			if (!isOTCv8) {
-				if (++count == 9 && isStacked) {
-					break;
-				} else if (count == MAX_STACKPOS_THINGS) {
-					return;
-				}
-			} else if (++count == MAX_STACKPOS_THINGS) {
-				break;
-			}
-		}
+	addItemsDescription(msg, description, 0, count);
+	if (!isOTCv8 && count == MAX_STACKPOS_THINGS) {
+		return;
 	}
 
 	const CreatureVector* creatures = tile->getCreatures();
@@ -837,14 +897,10 @@ void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage& msg)
 		}
 	}
 
-	if (items && count < MAX_STACKPOS_THINGS) {
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
-			msg.addItem(*it, isOTCv8);
-
-			if (++count == MAX_STACKPOS_THINGS) {
-				return;
-			}
-		}
+	if (count < MAX_STACKPOS_THINGS) {
+		const int32_t downCount =
+		    std::min<int32_t>(description.thingCount - description.topCount, MAX_STACKPOS_THINGS - count);
+		addItemsDescription(msg, description, description.topCount, description.topCount + downCount);
 	}
 }
 
@@ -1779,29 +1835,7 @@ void ProtocolGame::sendCreatureSay(const Creature* creature, SpeakClasses type,
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0xAA);
-	msg.add<uint32_t>(0x00);
-
-	msg.addString(creature->getName());
-
-	if (const Player* speaker = creature->getPlayer()) {
-		if (!speaker->isAccessPlayer() && !speaker->isAccountManager()) {
-			msg.add<uint16_t>(static_cast<uint16_t>(speaker->getLevel()));
-		} else {
-			msg.add<uint16_t>(0x00);
-		}
-	} else {
-		msg.add<uint16_t>(0x00);
-	}
-
-	msg.addByte(type);
-	if (pos) {
-		msg.addPosition(*pos);
-	} else {
-		msg.addPosition(creature->getPosition());
-	}
-
-	msg.addString(text);
+	AddCreatureSay(msg, creature, type, text, pos);
 	writeToOutputBuffer(msg);
 }
 
@@ -1899,39 +1933,40 @@ void ProtocolGame::sendPing()
 
 void ProtocolGame::sendDistanceShoot(const Position& from, const Position& to, uint8_t type)
 {
+	// effects are the first to go when the client cannot keep up, movement and health always get through
+	if (isSendBacklogged()) {
+		return;
+	}
+
 	NetworkMessage msg;
-	msg.addByte(0x85);
-	msg.addPosition(from);
-	msg.addPosition(to);
-	msg.addByte(type);
+	AddDistanceShoot(msg, from, to, type);
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type)
 {
-	if (!canSee(pos)) {
+	if (!canSee(pos) || isSendBacklogged()) {
 		return;
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0x83);
-	msg.addPosition(pos);
-	msg.addByte(type);
+	AddMagicEffect(msg, pos, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendEffectMessage(const NetworkMessage& msg, const Position* pos)
+{
+	if ((pos && !canSee(*pos)) || isSendBacklogged()) {
+		return;
+	}
+
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCreatureHealth(const Creature* creature)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
-
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil(
-		    (static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
-	}
+	AddCreatureHealth(msg, creature);
 	writeToOutputBuffer(msg);
 }
 
@@ -2404,6 +2439,10 @@ void ProtocolGame::sendOTCv8Features()
     msg.addByte(0x01); // bool - can change inventory options
     msg.addByte(0x01); // bool - can change show connections option
     msg.addByte(0x00); // bool - can change show outfit hotkey option
+    if (otcv8Features & OTCV8_FEATURE_COMPRESSION) {
+        // only clients that asked for compression know about this field
+        msg.addByte(isCompressionEnabled() ? 0x01 : 0x00); // bool - packets are deflated
+    }
     writeToOutputBuffer(msg);
 }
 
@@ -2705,18 +2744,80 @@ void ProtocolGame::MoveDownCreature(NetworkMessage& msg, const Creature* creatur
 
 void ProtocolGame::sendAnimatedText(std::string_view message, const Position& pos, TextColor_t color)
 {
-    if (!canSee(pos)) {
+    if (!canSee(pos) || isSendBacklogged()) {
         return;
     }
 
     NetworkMessage msg;
-    msg.addByte(0x84);
-    msg.addPosition(pos);
-    msg.addByte(color);
-    msg.addString(message);
+    AddAnimatedText(msg, message, pos, color);
     writeToOutputBuffer(msg);
 }
 
+void ProtocolGame::AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type)
+{
+	msg.addByte(0x85);
+	msg.addPosition(from);
+	msg.addPosition(to);
+	msg.addByte(type);
+}
+
+void ProtocolGame::AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type)
+{
+	msg.addByte(0x83);
+	msg.addPosition(pos);
+	msg.addByte(type);
+}
+
+void ProtocolGame::AddAnimatedText(NetworkMessage& msg, std::string_view message, const Position& pos,
+                                   TextColor_t color)
+{
+	msg.addByte(0x84);
+	msg.addPosition(pos);
+	msg.addByte(color);
+	msg.addString(message);
+}
+
+void ProtocolGame::AddCreatureHealth(NetworkMessage& msg, const Creature* creature)
+{
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+
+	if (creature->isHealthHidden()) {
+		msg.addByte(0x00);
+	} else {
+		msg.addByte(std::ceil(
+		    (static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	}
+}
+
+void ProtocolGame::AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type,
+                                  std::string_view text, const Position* pos)
+{
+	msg.addByte(0xAA);
+	msg.add<uint32_t>(0x00);
+
+	msg.addString(creature->getName());
+
+	if (const Player* speaker = creature->getPlayer()) {
+		if (!speaker->isAccessPlayer() && !speaker->isAccountManager()) {
+			msg.add<uint16_t>(static_cast<uint16_t>(speaker->getLevel()));
+		} else {
+			msg.add<uint16_t>(0x00);
+		}
+	} else {
+		msg.add<uint16_t>(0x00);
+	}
+
+	msg.addByte(type);
+	if (pos) {
+		msg.addPosition(*pos);
+	} else {
+		msg.addPosition(creature->getPosition());
+	}
+
+	msg.addString(text);
+}
+
 void ProtocolGame::AddWorldLight(NetworkMessage& msg, LightInfo lightInfo)
 {
     msg.addByte(0x82);
@@ -39,6 +39,8 @@ struct TextMessage
 
 inline constexpr auto OTCV8_NAME = "OTCv8";
 inline constexpr auto OTCV8_LENGTH = 5;
+// bits of the feature word an OTCv8 client may send after its version, older clients leave it zero
+inline constexpr uint16_t OTCV8_FEATURE_COMPRESSION = 1 << 0;
 
 class ProtocolGame final : public Protocol
 {
@@ -65,6 +67,16 @@ public:
 
 	uint16_t getVersion() const { return version; }
 
+	// Messages that look the same to every spectator. Game encodes them once with these and copies the result into
+	// the output buffer of each player, only the checks that depend on the viewer are done per player.
+	static void AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type);
+	static void AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
+	static void AddAnimatedText(NetworkMessage& msg, std::string_view message, const Position& pos,
+	                            TextColor_t color);
+	static void AddCreatureHealth(NetworkMessage& msg, const Creature* creature);
+	static void AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type, std::string_view text,
+	                           const Position* pos);
+
 private:
 	ProtocolGame_ptr getThis() { return std::static_pointer_cast<ProtocolGame>(shared_from_this()); }
 	void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
@@ -150,6 +162,8 @@ private:
 
 	void sendDistanceShoot(const Position& from, const Position& to, uint8_t type);
 	void sendMagicEffect(const Position& pos, uint8_t type);
+	// an effect encoded for all spectators, left out if the client is behind or pos is given and out of view
+	void sendEffectMessage(const NetworkMessage& msg, const Position* pos);
 	void sendCreatureHealth(const Creature* creature);
 	void sendSkills();
 	void sendPing();
@@ -268,6 +282,8 @@ private:
 	uint8_t challengeRandom = 0;
 
 	bool isOTCv8 = false;
+	// OTCV8_FEATURE_* bits the client sent in its login block
+	uint16_t otcv8Features = 0;
 	bool debugAssertSent = false;
 	bool acceptPackets = false;
 };
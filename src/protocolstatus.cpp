@@ -12,6 +12,7 @@
 extern Game g_game;
 
 std::map<uint32_t, int64_t> ProtocolStatus::ipConnectMap;
+std::mutex ProtocolStatus::ipConnectMapLock;
 const uint64_t ProtocolStatus::start = OTSYS_TIME();
 
 enum RequestedInfo_t : uint16_t
@@ -29,19 +30,22 @@ enum RequestedInfo_t : uint16_t
 void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 {
 	uint32_t ip = getIP();
-	if (ip != 0x0100007F) {
-		std::string ipStr = convertIPToString(ip);
-		if (ipStr != getString(ConfigManager::IP)) {
-			std::map<uint32_t, int64_t>::const_iterator it = ipConnectMap.find(ip);
-			if (it != ipConnectMap.end() &&
-			    (OTSYS_TIME() < (it->second + getInteger(ConfigManager::STATUSQUERY_TIMEOUT)))) {
-				disconnect();
-				return;
+	{
+		std::lock_guard<std::mutex> lockGuard(ipConnectMapLock);
+		if (ip != 0x0100007F) {
+			std::string ipStr = convertIPToString(ip);
+			if (ipStr != getString(ConfigManager::IP)) {
+				std::map<uint32_t, int64_t>::const_iterator it = ipConnectMap.find(ip);
+				if (it != ipConnectMap.end() &&
+				    (OTSYS_TIME() < (it->second + getInteger(ConfigManager::STATUSQUERY_TIMEOUT)))) {
+					disconnect();
+					return;
+				}
 			}
 		}
-	}
 
-	ipConnectMap[ip] = OTSYS_TIME();
+		ipConnectMap[ip] = OTSYS_TIME();
+	}
 
 	switch (msg.getByte()) {
 		// XML info protocol
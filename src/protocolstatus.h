@@ -35,7 +35,9 @@ public:
 	static const uint64_t start;
 
 private:
+	// status requests come in on every network thread
 	static std::map<uint32_t, int64_t> ipConnectMap;
+	static std::mutex ipConnectMapLock;
 };
 
 #endif
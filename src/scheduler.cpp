@@ -5,6 +5,49 @@
 
 #include "scheduler.h"
 
+#include "taskstats.h"
+
+namespace {
+
+// All scheduler tasks that expired in the same tick, run as one dispatcher task.
+class ExpiredEvents final : public Task
+{
+public:
+	explicit ExpiredEvents(std::vector<SchedulerTask*>&& tasks) :
+	    Task([this]() { run(); }, {TASK_CATEGORY_BATCH}), tasks(std::move(tasks))
+	{
+		// the events wait in the dispatcher queue from now on
+		if (TaskStatistics::isEnabled()) {
+			auto now = std::chrono::steady_clock::now();
+			for (SchedulerTask* task : this->tasks) {
+				task->setQueuedAt(now);
+			}
+		}
+	}
+
+	~ExpiredEvents() override
+	{
+		// tasks that never ran because the dispatcher was shut down
+		for (SchedulerTask* task : tasks) {
+			delete task;
+		}
+	}
+
+private:
+	void run()
+	{
+		for (SchedulerTask*& task : tasks) {
+			executeTask(*task);
+			delete task;
+			task = nullptr;
+		}
+	}
+
+	std::vector<SchedulerTask*> tasks;
+};
+
+} // namespace
+
 uint32_t Scheduler::addEvent(SchedulerTask* task)
 {
 	// check if the event has a valid id
@@ -12,25 +55,20 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 		task->setEventId(++lastEventId);
 	}
 
-	boost::asio::post(io_context, [this, task]() {
-		// insert the event id in the list of active events
-		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
-		auto& timer = it.first->second;
-
-		timer.expires_after(std::chrono::milliseconds(task->getDelay()));
-		timer.async_wait([this, task](const boost::system::error_code& error) {
-			eventIdTimerMap.erase(task->getEventId());
+	// round up, so that no event runs before its delay has passed
+	auto elapsed = std::chrono::ceil<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+	uint64_t expiry = elapsed.count() + task->getDelay();
 
-			if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
-				// the timer has been manually canceled(timer->cancel()) or Scheduler::shutdown has been called
-				delete task;
-				return;
-			}
-
-			g_dispatcher.addTask(task);
-		});
-	});
+	bool do_signal;
+	{
+		std::lock_guard<std::mutex> lockClass(commandLock);
+		do_signal = commands.empty();
+		commands.push_back({task, task->getEventId(), expiry});
+	}
 
+	if (do_signal) {
+		commandSignal.notify_one();
+	}
 	return task->getEventId();
 }
 
@@ -40,26 +78,305 @@ void Scheduler::stopEvent(uint32_t eventId)
 		return;
 	}
 
-	boost::asio::post(io_context, [this, eventId]() {
-		// search the event id
-		auto it = eventIdTimerMap.find(eventId);
-		if (it != eventIdTimerMap.end()) {
-			it->second.cancel();
-		}
-	});
+	bool do_signal;
+	{
+		std::lock_guard<std::mutex> lockClass(commandLock);
+		do_signal = commands.empty();
+		commands.push_back({nullptr, eventId, 0});
+	}
+
+	if (do_signal) {
+		commandSignal.notify_one();
+	}
 }
 
 void Scheduler::shutdown()
 {
 	setState(THREAD_STATE_TERMINATED);
-	boost::asio::post(io_context, [this]() {
-		// cancel all active timers
-		for (auto& it : eventIdTimerMap) {
-			it.second.cancel();
+
+	std::lock_guard<std::mutex> lockClass(commandLock);
+	commandSignal.notify_one();
+}
+
+void Scheduler::threadMain()
+{
+	std::vector<Command> tmpCommands;
+	std::vector<SchedulerTask*> expired;
+	// NOTE: second argument defer_lock is to prevent from immediate locking
+	std::unique_lock<std::mutex> commandLockUnique(commandLock, std::defer_lock);
+
+	while (true) {
+		commandLockUnique.lock();
+		if (getState() == THREAD_STATE_TERMINATED) {
+			break;
 		}
 
-		io_context.stop();
-	});
+		if (commands.empty()) {
+			// sleep until the next slot comes up or a command arrives
+			uint64_t nextTick = getNextTick();
+			if (nextTick == NO_TICK) {
+				commandSignal.wait(commandLockUnique);
+			} else {
+				commandSignal.wait_until(commandLockUnique, startTime + std::chrono::milliseconds(nextTick));
+			}
+		}
+		tmpCommands.swap(commands);
+		commandLockUnique.unlock();
+
+		for (const Command& command : tmpCommands) {
+			if (command.task) {
+				insertEvent(command);
+			} else {
+				cancelEvent(command.eventId);
+			}
+		}
+		tmpCommands.clear();
+
+		advance(getTick(std::chrono::steady_clock::now()), expired);
+		if (!expired.empty()) {
+			g_dispatcher.addTask(new ExpiredEvents(std::move(expired)));
+			expired.clear();
+		}
+	}
+
+	// Scheduler::shutdown has been called, drop every pending event
+	for (const Command& command : commands) {
+		delete command.task;
+	}
+	commands.clear();
+	commandLockUnique.unlock();
+
+	for (uint32_t index : eventTable) {
+		if (index != NO_EVENT) {
+			delete events[index].task;
+		}
+	}
+}
+
+void Scheduler::insertEvent(const Command& command)
+{
+	uint32_t index;
+	if (freeEvents != NO_EVENT) {
+		index = freeEvents;
+		freeEvents = events[index].next;
+	} else {
+		index = events.size();
+		events.emplace_back();
+	}
+
+	Event& event = events[index];
+	event.task = command.task;
+	// the slot of the current tick has been run already
+	event.expiry = std::max(command.expiry, currentTick + 1);
+	event.eventId = command.eventId;
+
+	addToTable(index);
+	link(index);
 }
 
-SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f) { return new SchedulerTask(delay, std::move(f)); }
+void Scheduler::cancelEvent(uint32_t eventId)
+{
+	uint32_t position = findEvent(eventId);
+	if (position == NO_EVENT) {
+		// the event has run already
+		return;
+	}
+
+	uint32_t index = eventTable[position];
+	removeFromTable(position);
+	unlink(index);
+
+	delete events[index].task;
+	events[index].next = freeEvents;
+	freeEvents = index;
+}
+
+void Scheduler::advance(uint64_t tick, std::vector<SchedulerTask*>& expired)
+{
+	while (currentTick < tick) {
+		// skip the ticks where nothing happens
+		uint64_t nextTick = getNextTick();
+		if (nextTick > tick) {
+			currentTick = tick;
+			return;
+		}
+		currentTick = nextTick;
+
+		// move the events of every slot starting at this tick down to the smaller wheels, largest wheel first
+		if ((currentTick & ((UINT64_C(1) << (WHEEL_COUNT * WHEEL_BITS)) - 1)) == 0) {
+			cascade(overflow);
+		}
+
+		for (uint32_t wheel = WHEEL_COUNT - 1; wheel > 0; --wheel) {
+			uint32_t shift = wheel * WHEEL_BITS;
+			if ((currentTick & ((UINT64_C(1) << shift) - 1)) == 0) {
+				uint32_t slot = (currentTick >> shift) & (WHEEL_SIZE - 1);
+				occupiedSlots[wheel] &= ~(UINT64_C(1) << slot);
+				cascade(wheels[wheel][slot]);
+			}
+		}
+
+		uint32_t slot = currentTick & (WHEEL_SIZE - 1);
+		EventList& list = wheels[0][slot];
+		for (uint32_t index = list.head; index != NO_EVENT;) {
+			Event& event = events[index];
+			uint32_t next = event.next;
+
+			removeFromTable(findTablePosition(index));
+			expired.push_back(event.task);
+			event.next = freeEvents;
+			freeEvents = index;
+
+			index = next;
+		}
+		list = {};
+		occupiedSlots[0] &= ~(UINT64_C(1) << slot);
+	}
+}
+
+uint64_t Scheduler::getNextTick() const
+{
+	// slots before the current position of a wheel are always empty, so the first occupied slot after it is the
+	// next one to come up; a slot of a smaller wheel always comes up before any slot of a larger one
+	for (uint32_t wheel = 0; wheel < WHEEL_COUNT; ++wheel) {
+		uint32_t shift = wheel * WHEEL_BITS;
+		uint32_t position = (currentTick >> shift) & (WHEEL_SIZE - 1);
+		uint64_t laterSlots = position == WHEEL_SIZE - 1 ? 0 : occupiedSlots[wheel] & (~UINT64_C(0) << (position + 1));
+		if (laterSlots != 0) {
+			uint64_t wheelStart = currentTick >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS);
+			return wheelStart + (static_cast<uint64_t>(std::countr_zero(laterSlots)) << shift);
+		}
+	}
+
+	if (overflow.head != NO_EVENT) {
+		return ((currentTick >> (WHEEL_COUNT * WHEEL_BITS)) + 1) << (WHEEL_COUNT * WHEEL_BITS);
+	}
+	return NO_TICK;
+}
+
+void Scheduler::link(uint32_t index)
+{
+	Event& event = events[index];
+
+	// the highest bit the expiry differs in from the current tick picks the wheel, so the event is moved down a
+	// wheel exactly when the current tick reaches the start of its slot
+	uint64_t difference = event.expiry ^ currentTick;
+	uint32_t wheel = difference == 0 ? 0 : (std::bit_width(difference) - 1) / WHEEL_BITS;
+	if (wheel < WHEEL_COUNT) {
+		event.wheel = wheel;
+		event.slot = (event.expiry >> (wheel * WHEEL_BITS)) & (WHEEL_SIZE - 1);
+		occupiedSlots[wheel] |= UINT64_C(1) << event.slot;
+	} else {
+		event.wheel = WHEEL_COUNT;
+		event.slot = 0;
+	}
+
+	EventList& list = getList(event);
+	event.prev = list.tail;
+	event.next = NO_EVENT;
+	if (list.tail != NO_EVENT) {
+		events[list.tail].next = index;
+	} else {
+		list.head = index;
+	}
+	list.tail = index;
+}
+
+void Scheduler::unlink(uint32_t index)
+{
+	Event& event = events[index];
+	EventList& list = getList(event);
+
+	if (event.prev != NO_EVENT) {
+		events[event.prev].next = event.next;
+	} else {
+		list.head = event.next;
+	}
+
+	if (event.next != NO_EVENT) {
+		events[event.next].prev = event.prev;
+	} else {
+		list.tail = event.prev;
+	}
+
+	if (list.head == NO_EVENT && event.wheel < WHEEL_COUNT) {
+		occupiedSlots[event.wheel] &= ~(UINT64_C(1) << event.slot);
+	}
+}
+
+void Scheduler::cascade(EventList& list)
+{
+	uint32_t index = list.head;
+	list = {};
+	while (index != NO_EVENT) {
+		uint32_t next = events[index].next;
+		link(index);
+		index = next;
+	}
+}
+
+uint32_t Scheduler::findEvent(uint32_t eventId) const
+{
+	size_t mask = eventTable.size() - 1;
+	for (size_t position = getTablePosition(eventId);; position = (position + 1) & mask) {
+		uint32_t index = eventTable[position];
+		if (index == NO_EVENT || events[index].eventId == eventId) {
+			return index == NO_EVENT ? NO_EVENT : position;
+		}
+	}
+}
+
+uint32_t Scheduler::findTablePosition(uint32_t index) const
+{
+	size_t mask = eventTable.size() - 1;
+	size_t position = getTablePosition(events[index].eventId);
+	while (eventTable[position] != index) {
+		position = (position + 1) & mask;
+	}
+	return position;
+}
+
+void Scheduler::addToTable(uint32_t index)
+{
+	if ((eventCount + 1) * 2 > eventTable.size()) {
+		std::vector<uint32_t> oldTable(eventTable.size() * 2, NO_EVENT);
+		oldTable.swap(eventTable);
+		--tableShift;
+		eventCount = 0;
+
+		for (uint32_t oldIndex : oldTable) {
+			if (oldIndex != NO_EVENT) {
+				addToTable(oldIndex);
+			}
+		}
+	}
+
+	size_t mask = eventTable.size() - 1;
+	size_t position = getTablePosition(events[index].eventId);
+	while (eventTable[position] != NO_EVENT) {
+		position = (position + 1) & mask;
+	}
+	eventTable[position] = index;
+	++eventCount;
+}
+
+void Scheduler::removeFromTable(uint32_t position)
+{
+	// shift later entries of the probe sequence back, so lookups never need tombstones
+	size_t mask = eventTable.size() - 1;
+	size_t hole = position;
+	for (size_t next = (hole + 1) & mask; eventTable[next] != NO_EVENT; next = (next + 1) & mask) {
+		size_t wanted = getTablePosition(events[eventTable[next]].eventId);
+		if (((next - wanted) & mask) >= ((next - hole) & mask)) {
+			eventTable[hole] = eventTable[next];
+			hole = next;
+		}
+	}
+	eventTable[hole] = NO_EVENT;
+	--eventCount;
+}
+
+SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f, const TaskTag& tag)
+{
+	return new SchedulerTask(delay, std::move(f), tag);
+}
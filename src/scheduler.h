@@ -18,16 +18,23 @@ public:
 	uint32_t getDelay() const { return delay; }
 
 private:
-	SchedulerTask(uint32_t delay, TaskFunc&& f) : Task(std::move(f)), delay(delay) {}
+	SchedulerTask(uint32_t delay, TaskFunc&& f, const TaskTag& tag) : Task(std::move(f), tag), delay(delay) {}
 
 	uint32_t eventId = 0;
 	uint32_t delay = 0;
 
-	friend SchedulerTask* createSchedulerTask(uint32_t, TaskFunc&&);
+	friend SchedulerTask* createSchedulerTask(uint32_t, TaskFunc&&, const TaskTag&);
 };
 
-SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f);
+SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f, const TaskTag& tag = {});
 
+/**
+ * Runs scheduler tasks after their delay on the dispatcher.
+ * Events are kept in a hierarchical timing wheel with millisecond ticks: wheel i has WHEEL_SIZE slots of
+ * WHEEL_SIZE^i ticks each, and an event moves down to a finer wheel when the slot it sits in comes up.
+ * Inserting and cancelling an event is constant time, and all events expiring in the same tick are handed to the
+ * dispatcher as a single task.
+ */
 class Scheduler : public ThreadHolder<Scheduler>
 {
 public:
@@ -36,13 +43,87 @@ public:
 
 	void shutdown();
 
-	void threadMain() { io_context.run(); }
+	void threadMain();
 
 private:
+	static constexpr uint32_t WHEEL_BITS = 6;
+	static constexpr uint32_t WHEEL_SIZE = 1 << WHEEL_BITS;
+	static constexpr uint32_t WHEEL_COUNT = 6;
+	static constexpr uint32_t NO_EVENT = std::numeric_limits<uint32_t>::max();
+	static constexpr uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+
+	struct Event
+	{
+		SchedulerTask* task;
+		uint64_t expiry;
+		// neighbours in the slot list, or the next free event
+		uint32_t prev;
+		uint32_t next;
+		uint32_t eventId;
+		// WHEEL_COUNT for events too far ahead for the largest wheel
+		uint8_t wheel;
+		uint8_t slot;
+	};
+
+	struct EventList
+	{
+		uint32_t head = NO_EVENT;
+		uint32_t tail = NO_EVENT;
+	};
+
+	// a null task cancels the event
+	struct Command
+	{
+		SchedulerTask* task;
+		uint32_t eventId;
+		uint64_t expiry;
+	};
+
+	uint64_t getTick(std::chrono::steady_clock::time_point time) const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(time - startTime).count();
+	}
+
+	void insertEvent(const Command& command);
+	void cancelEvent(uint32_t eventId);
+	void advance(uint64_t tick, std::vector<SchedulerTask*>& expired);
+	uint64_t getNextTick() const;
+
+	void link(uint32_t index);
+	void unlink(uint32_t index);
+	EventList& getList(const Event& event)
+	{
+		return event.wheel < WHEEL_COUNT ? wheels[event.wheel][event.slot] : overflow;
+	}
+	void cascade(EventList& list);
+
+	uint32_t findEvent(uint32_t eventId) const;
+	uint32_t findTablePosition(uint32_t index) const;
+	void addToTable(uint32_t index);
+	void removeFromTable(uint32_t position);
+	size_t getTablePosition(uint32_t eventId) const { return (eventId * UINT32_C(0x9E3779B1)) >> tableShift; }
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 	std::atomic<uint32_t> lastEventId{0};
-	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
-	boost::asio::io_context io_context;
-	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
+
+	std::mutex commandLock;
+	std::condition_variable commandSignal;
+	std::vector<Command> commands;
+
+	// everything below is only touched by the scheduler thread
+	std::vector<Event> events;
+	uint32_t freeEvents = NO_EVENT;
+
+	// open addressing table from event id to index in events, kept at most half full
+	std::vector<uint32_t> eventTable = std::vector<uint32_t>(1024, NO_EVENT);
+	uint32_t tableShift = 32 - 10;
+	size_t eventCount = 0;
+
+	std::array<std::array<EventList, WHEEL_SIZE>, WHEEL_COUNT> wheels;
+	// bit i is set if slot i of the wheel holds events
+	std::array<uint64_t, WHEEL_COUNT> occupiedSlots = {};
+	EventList overflow;
+	uint64_t currentTick = 0;
 };
 
 extern Scheduler g_scheduler;
@@ -19,18 +19,65 @@
 
 Ban g_bans;
 
+namespace {
+
+#ifdef __linux__
+// Linux spreads the connections of a port evenly over all sockets listening on it with this option
+using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+constexpr bool acceptorPerContext = true;
+#else
+constexpr bool acceptorPerContext = false;
+#endif
+
+} // namespace
+
 // ServiceManager implementation
 ServiceManager::ServiceManager() : signals(io_context), death_timer(io_context) {}
 
 ServiceManager::~ServiceManager() { stop(); }
 
-void ServiceManager::die() { io_context.stop(); }
+void ServiceManager::die()
+{
+	io_context.stop();
+	for (auto& extraContext : extraContexts) {
+		extraContext->stop();
+	}
+}
+
+void ServiceManager::setThreadCount(size_t threadCount)
+{
+	assert(acceptors.empty() && !running);
+	for (size_t i = 1; i < threadCount; ++i) {
+		auto& extraContext = extraContexts.emplace_back(std::make_unique<boost::asio::io_context>(1));
+		workGuards.push_back(boost::asio::make_work_guard(*extraContext));
+	}
+
+	if (acceptorPerContext && threadCount > 1) {
+		std::cout << "> Network threads share each port with SO_REUSEPORT, another process of the same user that "
+		             "binds it the same way gets a share of its connections."
+		          << std::endl;
+	}
+}
 
 void ServiceManager::run()
 {
 	assert(!running);
 	running = true;
+
+	for (auto& extraContext : extraContexts) {
+		threads.emplace_back([&context = *extraContext]() {
+			Dispatcher::setNetworkThread();
+			context.run();
+		});
+	}
+
+	Dispatcher::setNetworkThread();
 	io_context.run();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
 }
 
 void ServiceManager::stop()
@@ -43,20 +90,27 @@ void ServiceManager::stop()
 
 	for (auto& servicePortIt : acceptors) {
 		try {
-			boost::asio::post(io_context, [servicePort = servicePortIt.second]() { servicePort->onStopServer(); });
+			servicePortIt.second->onStopServer();
 		} catch (const boost::system::system_error& e) {
 			std::cout << "[ServiceManager::stop] Network Error: " << e.what() << std::endl;
 		}
 	}
 
 	acceptors.clear();
+	workGuards.clear();
 
 	death_timer.expires_after(std::chrono::seconds(3));
 	death_timer.async_wait([this](const boost::system::error_code&) { die(); });
 }
 
 // ServicePort implementation
-ServicePort::~ServicePort() { close(); }
+ServicePort::ServicePort(std::vector<boost::asio::io_context*> io_contexts) : io_contexts(std::move(io_contexts))
+{
+	size_t count = acceptorPerContext ? this->io_contexts.size() : 1;
+	for (size_t i = 0; i < count; ++i) {
+		acceptors.push_back(std::make_shared<boost::asio::ip::tcp::acceptor>(*this->io_contexts[i]));
+	}
+}
 
 bool ServicePort::is_single_socket() const { return !services.empty() && services.front()->is_single_socket(); }
 
@@ -75,49 +129,59 @@ std::string ServicePort::get_protocol_names() const
 	return str;
 }
 
-void ServicePort::accept()
+void ServicePort::accept(size_t index)
 {
-	if (!acceptor) {
-		return;
-	}
+	// a shared acceptor spreads its connections over all io_contexts
+	boost::asio::io_context& io_context =
+	    acceptors.size() > 1 ? *io_contexts[index]
+	                         : *io_contexts[nextContext.fetch_add(1, std::memory_order_relaxed) % io_contexts.size()];
 
 	auto connection = ConnectionManager::getInstance().createConnection(io_context, shared_from_this());
-	acceptor->async_accept(connection->getSocket(),
-	                       [=, thisPtr = shared_from_this()](const boost::system::error_code& error) {
-		                       thisPtr->onAccept(connection, error);
-	                       });
+	acceptors[index]->async_accept(connection->getSocket(),
+	                               [=, thisPtr = shared_from_this()](const boost::system::error_code& error) {
+		                               thisPtr->onAccept(index, connection, error);
+	                               });
 }
 
-void ServicePort::onAccept(Connection_ptr connection, const boost::system::error_code& error)
+void ServicePort::onAccept(size_t index, Connection_ptr connection, const boost::system::error_code& error)
 {
 	if (!error) {
 		if (services.empty()) {
 			return;
 		}
 
-		const auto remote_ip = connection->getIP();
-		if (remote_ip != 0 && g_bans.acceptConnection(remote_ip)) {
-			Service_ptr service = services.front();
-			if (service->is_single_socket()) {
-				connection->accept(service->make_protocol(connection));
+		// the rest runs on the strand of the connection, which may belong to another io_context
+		boost::asio::dispatch(connection->strand, [connection, service = services.front()]() {
+			connection->resolveIP();
+			const auto remote_ip = connection->getIP();
+			if (remote_ip != 0 && g_bans.acceptConnection(remote_ip)) {
+				if (service->is_single_socket()) {
+					connection->accept(service->make_protocol(connection));
+				} else {
+					connection->accept();
+				}
 			} else {
-				connection->accept();
+				connection->close(Connection::FORCE_CLOSE);
 			}
-		} else {
-			connection->close(Connection::FORCE_CLOSE);
-		}
+		});
 
-		accept();
+		accept(index);
 	} else if (error != boost::asio::error::operation_aborted) {
-		if (!pendingStart) {
-			close();
-			pendingStart = true;
-			g_scheduler.addEvent(createSchedulerTask(
-			    15000, [serverPort = this->serverPort, service = std::weak_ptr<ServicePort>(shared_from_this())]() {
-				    openAcceptor(service, serverPort);
-			    }));
-		}
+		scheduleOpen();
+	}
+}
+
+void ServicePort::scheduleOpen()
+{
+	if (pendingStart.exchange(true)) {
+		return;
 	}
+
+	close();
+	g_scheduler.addEvent(createSchedulerTask(
+	    15000, [serverPort = serverPort.load(), service = std::weak_ptr<ServicePort>(shared_from_this())]() {
+		    openAcceptor(service, serverPort);
+	    }));
 }
 
 Protocol_ptr ServicePort::make_protocol(bool checksummed, NetworkMessage& msg, const Connection_ptr& connection) const
@@ -146,40 +210,61 @@ void ServicePort::openAcceptor(std::weak_ptr<ServicePort> weak_service, uint16_t
 
 void ServicePort::open(uint16_t port)
 {
-	close();
-
 	serverPort = port;
 	pendingStart = false;
 
+	// called from the scheduler when reopening, the acceptors are only touched on their own io_context
+	for (size_t i = 0; i < acceptors.size(); ++i) {
+		boost::asio::post(acceptors[i]->get_executor(),
+		                  [i, port, thisPtr = shared_from_this()]() { thisPtr->listen(i, port); });
+	}
+}
+
+void ServicePort::listen(size_t index, uint16_t port)
+{
+	auto& acceptor = *acceptors[index];
+	if (acceptor.is_open()) {
+		boost::system::error_code error;
+		acceptor.close(error);
+	}
+
 	try {
+		boost::asio::ip::tcp::endpoint endpoint;
 		if (getBoolean(ConfigManager::BIND_ONLY_GLOBAL_ADDRESS)) {
-			acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(
-			    io_context,
-			    boost::asio::ip::tcp::endpoint(
-			        boost::asio::ip::make_address_v4(getString(ConfigManager::IP)),
-			        serverPort));
+			endpoint = {boost::asio::ip::make_address_v4(getString(ConfigManager::IP)), port};
 		} else {
-			acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(
-			    io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4(INADDR_ANY), serverPort));
+			endpoint = {boost::asio::ip::address_v4(INADDR_ANY), port};
 		}
 
-		acceptor->set_option(boost::asio::ip::tcp::no_delay(true));
-		accept();
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef __linux__
+		if (acceptors.size() > 1) {
+			acceptor.set_option(reuse_port(true));
+		}
+#endif
+		acceptor.bind(endpoint);
+		acceptor.listen();
+		acceptor.set_option(boost::asio::ip::tcp::no_delay(true));
 	} catch (const boost::system::system_error& e) {
-		std::cout << "[ServicePort::open] Error: " << e.what() << std::endl;
-
-		pendingStart = true;
-		g_scheduler.addEvent(createSchedulerTask(
-		    15000,
-		    [port, service = std::weak_ptr<ServicePort>(shared_from_this())]() { openAcceptor(service, port); }));
+		std::cout << "[ServicePort::listen] Error: " << e.what() << std::endl;
+		scheduleOpen();
+		return;
 	}
+
+	accept(index);
 }
 
 void ServicePort::close()
 {
-	if (acceptor && acceptor->is_open()) {
-		boost::system::error_code error;
-		acceptor->close(error);
+	// every acceptor is closed by the io_context that runs its handlers
+	for (auto& acceptor : acceptors) {
+		boost::asio::post(acceptor->get_executor(), [acceptor]() {
+			if (acceptor->is_open()) {
+				boost::system::error_code error;
+				acceptor->close(error);
+			}
+		});
 	}
 }
 
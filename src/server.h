@@ -40,11 +40,17 @@ public:
 	Protocol_ptr make_protocol(const Connection_ptr& c) const override { return std::make_shared<ProtocolType>(c); }
 };
 
+/**
+ * Listens on one port. Where the kernel spreads connections over several listeners of the same port (SO_REUSEPORT
+ * on Linux) and there is more than one io_context, every io_context gets its own acceptor and keeps the connections
+ * it accepts. Otherwise a single acceptor hands the connections to the io_contexts in turn.
+ * The acceptors are created once and only ever touched on their own io_context, opening and closing them is posted
+ * there.
+ */
 class ServicePort : public std::enable_shared_from_this<ServicePort>
 {
 public:
-	explicit ServicePort(boost::asio::io_context& io_context) : io_context(io_context) {}
-	~ServicePort();
+	explicit ServicePort(std::vector<boost::asio::io_context*> io_contexts);
 
 	// non-copyable
 	ServicePort(const ServicePort&) = delete;
@@ -60,17 +66,24 @@ public:
 	Protocol_ptr make_protocol(bool checksummed, NetworkMessage& msg, const Connection_ptr& connection) const;
 
 	void onStopServer();
-	void onAccept(Connection_ptr connection, const boost::system::error_code& error);
+	void onAccept(size_t index, Connection_ptr connection, const boost::system::error_code& error);
 
 private:
-	void accept();
+	// these run on the io_context of the acceptor
+	void listen(size_t index, uint16_t port);
+	void accept(size_t index);
 
-	boost::asio::io_context& io_context;
-	std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+	void scheduleOpen();
+
+	std::vector<boost::asio::io_context*> io_contexts;
+	// one per io_context or a single one, the vector does not change after construction
+	std::vector<std::shared_ptr<boost::asio::ip::tcp::acceptor>> acceptors;
 	std::vector<Service_ptr> services;
+	std::atomic<size_t> nextContext{0};
 
-	uint16_t serverPort = 0;
-	bool pendingStart = false;
+	// set by open, which runs on the scheduler when the port is reopened
+	std::atomic<uint16_t> serverPort{0};
+	std::atomic<bool> pendingStart{false};
 };
 
 class ServiceManager
@@ -83,6 +96,10 @@ public:
 	ServiceManager(const ServiceManager&) = delete;
 	ServiceManager& operator=(const ServiceManager&) = delete;
 
+	// has to be called before the first service is added
+	void setThreadCount(size_t threadCount);
+
+	// runs the first io_context on the calling thread and every other one on a thread of its own
 	void run();
 	void stop();
 
@@ -95,7 +112,12 @@ private:
 	void die();
 
 	std::unordered_map<uint16_t, ServicePort_ptr> acceptors;
+	// also handles the signals and the shutdown timer
 	boost::asio::io_context io_context;
+	std::vector<std::unique_ptr<boost::asio::io_context>> extraContexts;
+	// keeps an extra io_context running while it has no connections
+	std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> workGuards;
+	std::vector<std::thread> threads;
 	Signals signals; // No initialization here
 	boost::asio::steady_timer death_timer;
 	bool running = false;
@@ -114,7 +136,12 @@ bool ServiceManager::add(uint16_t port)
 	auto foundServicePort = acceptors.find(port);
 
 	if (foundServicePort == acceptors.end()) {
-		service_port = std::make_shared<ServicePort>(io_context);
+		std::vector<boost::asio::io_context*> io_contexts{&io_context};
+		for (auto& extraContext : extraContexts) {
+			io_contexts.push_back(extraContext.get());
+		}
+
+		service_port = std::make_shared<ServicePort>(std::move(io_contexts));
 		service_port->open(port);
 		acceptors[port] = service_port;
 	} else {
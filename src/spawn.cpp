@@ -245,7 +245,8 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 void Spawn::startSpawnCheck()
 {
 	if (checkSpawnEvent == 0) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
+		checkSpawnEvent = g_scheduler.addEvent(
+		    createSchedulerTask(getInterval(), [this]() { checkSpawn(); }, {TASK_CATEGORY_GAME}));
 	}
 }
 
@@ -381,7 +382,8 @@ void Spawn::checkSpawn()
 	}
 
 	if (spawnedMap.size() < spawnMap.size()) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
+		checkSpawnEvent = g_scheduler.addEvent(
+		    createSchedulerTask(getInterval(), [this]() { checkSpawn(); }, {TASK_CATEGORY_GAME}));
 	}
 }
 
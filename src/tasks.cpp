@@ -7,71 +7,212 @@
 
 #include "enums.h"
 #include "game.h"
+#include "lockfree.h"
+#include "taskstats.h"
 
 extern Game g_game;
 
-Task* createTask(TaskFunc&& f) { return new Task(std::move(f)); }
+namespace {
 
-Task* createTask(uint32_t expiration, TaskFunc&& f) { return new Task(expiration, std::move(f)); }
+// every task type has to fit into one block, larger ones fall back to the global allocator
+constexpr size_t TASK_BLOCK_SIZE = 128;
+constexpr size_t TASK_FREE_LIST_CAPACITY = 8192;
 
-void Dispatcher::threadMain()
+using TaskFreeList = LockfreeFreeList<TASK_BLOCK_SIZE, TASK_FREE_LIST_CAPACITY>;
+
+// how often the dispatcher thread checks for new tasks before it goes to sleep
+constexpr int DISPATCHER_SPIN_COUNT = 64;
+
+} // namespace
+
+void* Task::operator new(size_t size)
+{
+	if (size > TASK_BLOCK_SIZE) {
+		return ::operator new(size);
+	}
+
+	void* p;
+	if (!TaskFreeList::get().pop(p)) {
+		p = ::operator new(TASK_BLOCK_SIZE);
+	}
+	return p;
+}
+
+void Task::operator delete(void* p, size_t size)
 {
-	std::vector<Task*> tmpTaskList;
-	// NOTE: second argument defer_lock is to prevent from immediate locking
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
+	if (size > TASK_BLOCK_SIZE) {
+		::operator delete(p);
+		return;
+	}
+
+	if (!TaskFreeList::get().bounded_push(p)) {
+		::operator delete(p);
+	}
+}
+
+Task* createTask(TaskFunc&& f, const TaskTag& tag) { return new Task(std::move(f), tag); }
+
+Task* createTask(uint32_t expiration, TaskFunc&& f, const TaskTag& tag)
+{
+	return new Task(expiration, std::move(f), tag);
+}
+
+bool executeTask(Task& task)
+{
+	if (!TaskStatistics::isEnabled() || task.getTag().category == TASK_CATEGORY_BATCH) {
+		if (task.hasExpired()) {
+			return false;
+		}
+
+		task();
+		return true;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	// the task was queued before the statistics were enabled
+	auto queuedAt = task.getQueuedAt() != std::chrono::steady_clock::time_point{} ? task.getQueuedAt() : start;
+	if (task.hasExpired()) {
+		TaskStatistics::recordExpired(task.getTag(), start - queuedAt);
+		return false;
+	}
+
+	task();
+	TaskStatistics::recordRun(task.getTag(), start - queuedAt, std::chrono::steady_clock::now() - start);
+	return true;
+}
+
+void TaskQueue::push(Task* task)
+{
+	task->next.store(nullptr, std::memory_order_relaxed);
+	Task* prev = head.exchange(task, std::memory_order_acq_rel);
+	// until this store the task is not reachable from tail yet, pop then reports an empty queue
+	prev->next.store(task, std::memory_order_release);
+}
+
+Task* TaskQueue::pop()
+{
+	Task* task = tail;
+	Task* next = task->next.load(std::memory_order_acquire);
+	if (task == &stub) {
+		if (!next) {
+			return nullptr;
+		}
+
+		tail = next;
+		task = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next) {
+		tail = next;
+		return task;
+	}
 
+	if (task != head.load(std::memory_order_acquire)) {
+		// a producer has taken the place after task but not linked it yet
+		return nullptr;
+	}
+
+	// task is the last one, put the stub behind it so that it can be handed out
+	push(&stub);
+
+	next = task->next.load(std::memory_order_acquire);
+	if (next) {
+		tail = next;
+		return task;
+	}
+	return nullptr;
+}
+
+thread_local bool Dispatcher::networkThread = false;
+
+void Dispatcher::threadMain()
+{
 	while (getState() != THREAD_STATE_TERMINATED) {
-		// check if there are tasks waiting
-		taskLockUnique.lock();
-		if (taskList.empty()) {
-			// if the list is empty wait for signal
-			taskSignal.wait(taskLockUnique);
+		Task* task = taskQueue.pop();
+		if (!task) {
+			waitForTask();
+			continue;
 		}
-		tmpTaskList.swap(taskList);
-		taskLockUnique.unlock();
-
-		for (Task* task : tmpTaskList) {
-			if (!task->hasExpired()) {
-				++dispatcherCycle;
-				// execute it
-				(*task)();
-			}
-			delete task;
+
+		runTask(task);
+	}
+}
+
+size_t Dispatcher::runNetworkTasks()
+{
+	// dispatcher thread
+	size_t count = 0;
+	while (Task* task = networkTaskQueue.pop()) {
+		runTask(task);
+		++count;
+	}
+	return count;
+}
+
+void Dispatcher::runTask(Task* task)
+{
+	++dispatcherCycle;
+	executeTask(*task);
+	delete task;
+}
+
+void Dispatcher::waitForTask()
+{
+	// tasks usually come in bursts, so look again a few times before going to sleep
+	for (int i = 0; i < DISPATCHER_SPIN_COUNT; ++i) {
+		if (!taskQueue.empty()) {
+			return;
 		}
-		tmpTaskList.clear();
+		std::this_thread::yield();
+	}
+
+	// announce the sleep before the last look, a producer pushing after that look sees the flag and wakes us up
+	parked.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!taskQueue.empty()) {
+		parked.store(false, std::memory_order_relaxed);
+		return;
 	}
+
+	parked.wait(true, std::memory_order_acquire);
 }
 
-void Dispatcher::addTask(Task* task)
+void Dispatcher::push(Task* task)
 {
-	bool do_signal = false;
+	taskQueue.push(task);
 
-	taskLock.lock();
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (parked.load(std::memory_order_relaxed)) {
+		parked.store(false, std::memory_order_release);
+		parked.notify_one();
+	}
+}
 
-	if (getState() == THREAD_STATE_RUNNING) {
-		do_signal = taskList.empty();
-		taskList.push_back(task);
-	} else {
+void Dispatcher::addTask(Task* task)
+{
+	if (getState() != THREAD_STATE_RUNNING) {
 		delete task;
+		return;
 	}
 
-	taskLock.unlock();
+	if (TaskStatistics::isEnabled()) {
+		task->setQueuedAt(std::chrono::steady_clock::now());
+	}
 
-	// send a signal if the list was empty
-	if (do_signal) {
-		taskSignal.notify_one();
+	if (networkThread && task->getTag().category == TASK_CATEGORY_OTHER) {
+		task->setCategory(TASK_CATEGORY_NETWORK);
+	}
+
+	if (networkThread && holdNetworkTasks.load(std::memory_order_relaxed)) {
+		// the game loop picks it up at the start of the next tick, no need to wake the dispatcher
+		networkTaskQueue.push(task);
+	} else {
+		push(task);
 	}
 }
 
 void Dispatcher::shutdown()
 {
-	Task* task = createTask([this]() {
-		setState(THREAD_STATE_TERMINATED);
-		taskSignal.notify_one();
-	});
-
-	std::lock_guard<std::mutex> lockClass(taskLock);
-	taskList.push_back(task);
-
-	taskSignal.notify_one();
+	push(createTask([this]() { setState(THREAD_STATE_TERMINATED); }));
 }
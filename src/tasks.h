@@ -6,22 +6,150 @@
 
 #include "thread_holder_base.h"
 
-using TaskFunc = std::function<void(void)>;
+/**
+ * Move-only callable run by a task.
+ * Callables of up to INLINE_SIZE bytes are stored inside the object, so creating a task does not allocate anything
+ * besides the pooled task itself; larger ones are moved to the heap.
+ */
+class TaskFunc
+{
+public:
+	static constexpr size_t INLINE_SIZE = 48;
+
+	TaskFunc() = default;
+
+	template <class F>
+	    requires(!std::same_as<std::decay_t<F>, TaskFunc> && std::invocable<std::decay_t<F>&>)
+	TaskFunc(F&& f)
+	{
+		using Callable = std::decay_t<F>;
+		if constexpr (fitsInline<Callable>) {
+			new (storage) Callable(std::forward<F>(f));
+			ops = &inlineOps<Callable>;
+		} else {
+			new (storage) Callable*(new Callable(std::forward<F>(f)));
+			ops = &heapOps<Callable>;
+		}
+	}
+
+	TaskFunc(TaskFunc&& other) noexcept : ops(other.ops)
+	{
+		if (ops) {
+			ops->move(other.storage, storage);
+			other.ops = nullptr;
+		}
+	}
+
+	TaskFunc& operator=(TaskFunc&& other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			ops = other.ops;
+			if (ops) {
+				ops->move(other.storage, storage);
+				other.ops = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	~TaskFunc() { reset(); }
+
+	void operator()() { ops->call(storage); }
+
+	explicit operator bool() const { return ops != nullptr; }
+
+private:
+	struct Ops
+	{
+		void (*call)(void* storage);
+		// move constructs into to and destroys from
+		void (*move)(void* from, void* to);
+		void (*destroy)(void* storage);
+	};
+
+	template <class F>
+	static constexpr bool fitsInline =
+	    sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+	template <class F>
+	static constexpr Ops inlineOps = {
+	    [](void* storage) { (*static_cast<F*>(storage))(); },
+	    [](void* from, void* to) {
+		    new (to) F(std::move(*static_cast<F*>(from)));
+		    static_cast<F*>(from)->~F();
+	    },
+	    [](void* storage) { static_cast<F*>(storage)->~F(); },
+	};
+
+	template <class F>
+	static constexpr Ops heapOps = {
+	    [](void* storage) { (**static_cast<F**>(storage))(); },
+	    [](void* from, void* to) { new (to) F*(*static_cast<F**>(from)); },
+	    [](void* storage) { delete *static_cast<F**>(storage); },
+	};
+
+	void reset()
+	{
+		if (ops) {
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+	alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+	const Ops* ops = nullptr;
+};
+
 const int DISPATCHER_TASK_EXPIRATION = 2000;
 const auto SYSTEM_TIME_ZERO = std::chrono::system_clock::time_point(std::chrono::milliseconds(0));
 
+enum TaskCategory_t : uint8_t
+{
+	TASK_CATEGORY_OTHER,
+	// packet handling, tasks posted from network threads get it unless they are tagged otherwise
+	TASK_CATEGORY_NETWORK,
+	TASK_CATEGORY_LUA,
+	TASK_CATEGORY_DATABASE,
+	TASK_CATEGORY_PATHFINDING,
+	TASK_CATEGORY_CREATURE,
+	TASK_CATEGORY_GAME,
+	// runs other tasks that are recorded on their own, not recorded itself
+	TASK_CATEGORY_BATCH,
+
+	TASK_CATEGORY_LAST = TASK_CATEGORY_BATCH,
+};
+
+/**
+ * What a task is for and where it was created, used to break the task statistics down.
+ * The location defaults to the call site of createTask, createSchedulerTask or Dispatcher::addTask, so tagging a call
+ * site only takes its category: createSchedulerTask(delay, f, {TASK_CATEGORY_LUA}).
+ */
+struct TaskTag
+{
+	TaskCategory_t category = TASK_CATEGORY_OTHER;
+	std::source_location location = std::source_location::current();
+};
+
 class Task
 {
 public:
 	// DO NOT allocate this class on the stack
-	explicit Task(TaskFunc&& f) : func(std::move(f)) {}
-	Task(uint32_t ms, TaskFunc&& f) :
-	    expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f))
+	explicit Task(TaskFunc&& f, const TaskTag& tag = {}) : func(std::move(f)), tag(tag) {}
+	Task(uint32_t ms, TaskFunc&& f, const TaskTag& tag = {}) :
+	    expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f)), tag(tag)
 	{}
 
 	virtual ~Task() = default;
 	void operator()() { func(); }
 
+	const TaskTag& getTag() const { return tag; }
+	void setCategory(TaskCategory_t category) { tag.category = category; }
+
+	// when the task was handed to the dispatcher, only set while task statistics are enabled
+	std::chrono::steady_clock::time_point getQueuedAt() const { return queuedAt; }
+	void setQueuedAt(std::chrono::steady_clock::time_point time) { queuedAt = time; }
+
 	void setDontExpire() { expiration = SYSTEM_TIME_ZERO; }
 
 	bool hasExpired() const
@@ -32,6 +160,10 @@ public:
 		return expiration < std::chrono::system_clock::now();
 	}
 
+	// tasks and the classes derived from them are recycled through a lock-free free list of fixed size blocks
+	static void* operator new(size_t size);
+	static void operator delete(void* p, size_t size);
+
 protected:
 	std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
 
@@ -39,31 +171,86 @@ private:
 	// Expiration has another meaning for scheduler tasks, then it is the time the task should be added to the
 	// dispatcher
 	TaskFunc func;
+
+	// link in the dispatcher queue
+	std::atomic<Task*> next{nullptr};
+
+	TaskTag tag;
+	std::chrono::steady_clock::time_point queuedAt;
+
+	friend class TaskQueue;
 };
 
-Task* createTask(TaskFunc&& f);
-Task* createTask(uint32_t expiration, TaskFunc&& f);
+Task* createTask(TaskFunc&& f, const TaskTag& tag = {});
+Task* createTask(uint32_t expiration, TaskFunc&& f, const TaskTag& tag = {});
+
+// Runs the task unless it has expired and records it in the task statistics, returns whether it ran.
+bool executeTask(Task& task);
+
+/**
+ * Intrusive lock-free queue with many producers and a single consumer, linked through Task::next.
+ * Pushing is one atomic exchange and never blocks; pop may only be called by the consumer thread.
+ */
+class TaskQueue
+{
+public:
+	TaskQueue() = default;
+
+	// non-copyable
+	TaskQueue(const TaskQueue&) = delete;
+	TaskQueue& operator=(const TaskQueue&) = delete;
+
+	void push(Task* task);
+	// returns nullptr if the queue is empty or the only task in it is still being pushed
+	Task* pop();
+	// whether pop has nothing left, not counting tasks that are still being pushed
+	bool empty() const { return tail == &stub && !stub.next.load(std::memory_order_acquire); }
+
+private:
+	// the queue is never empty of nodes, stub takes the place of the last task once it has been popped
+	Task stub{TaskFunc{}};
+	std::atomic<Task*> head{&stub};
+	Task* tail = &stub;
+};
 
 class Dispatcher : public ThreadHolder<Dispatcher>
 {
 public:
 	void addTask(Task* task);
 
-	void addTask(TaskFunc&& f) { addTask(new Task(std::move(f))); }
+	void addTask(TaskFunc&& f, const TaskTag& tag = {}) { addTask(new Task(std::move(f), tag)); }
 
-	void addTask(uint32_t expiration, TaskFunc&& f) { addTask(new Task(expiration, std::move(f))); }
+	void addTask(uint32_t expiration, TaskFunc&& f, const TaskTag& tag = {})
+	{
+		addTask(new Task(expiration, std::move(f), tag));
+	}
 
 	void shutdown();
 
 	uint64_t getDispatcherCycle() const { return dispatcherCycle; }
 
+	// While held, tasks posted from network threads wait in a separate queue until runNetworkTasks is called, which
+	// lets the fixed tick game loop handle all input at the start of a tick.
+	void setHoldNetworkTasks(bool hold) { holdNetworkTasks.store(hold, std::memory_order_relaxed); }
+	size_t runNetworkTasks();
+
+	// called by every thread that runs an io_context
+	static void setNetworkThread() { networkThread = true; }
+
 	void threadMain();
 
 private:
-	std::mutex taskLock;
-	std::condition_variable taskSignal;
+	void push(Task* task);
+	void runTask(Task* task);
+	void waitForTask();
+
+	static thread_local bool networkThread;
 
-	std::vector<Task*> taskList;
+	TaskQueue taskQueue;
+	TaskQueue networkTaskQueue;
+	// set while the dispatcher thread sleeps, producers clear it and wake the thread up
+	std::atomic<bool> parked{false};
+	std::atomic<bool> holdNetworkTasks{false};
 	uint64_t dispatcherCycle = 0;
 };
 
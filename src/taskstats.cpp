@@ -0,0 +1,284 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "taskstats.h"
+
+namespace {
+
+// call sites beyond this are recorded together in one site without a location
+constexpr size_t MAX_TASK_SITES = 1024;
+
+struct TaskSite
+{
+	explicit TaskSite(const TaskTag& tag) : category(tag.category), location(tag.location) {}
+
+	TaskCategory_t category;
+	std::source_location location;
+	LatencyHistogram wait;
+	LatencyHistogram run;
+	std::atomic<uint64_t> expired{0};
+};
+
+// inlined call sites may hand out different copies of the same file name, so the key compares their contents
+struct TaskSiteKey
+{
+	std::string_view file;
+	uint_least32_t line;
+	uint_least32_t column;
+	TaskCategory_t category;
+
+	bool operator==(const TaskSiteKey&) const = default;
+};
+
+struct TaskSiteKeyHash
+{
+	size_t operator()(const TaskSiteKey& key) const
+	{
+		size_t hash = std::hash<std::string_view>{}(key.file);
+		hash ^= (static_cast<size_t>(key.line) << 16) ^ (static_cast<size_t>(key.column) << 8) ^ key.category;
+		return hash;
+	}
+};
+
+std::atomic<bool> recording{false};
+std::atomic<std::chrono::steady_clock::rep> recordingSince{0};
+
+// sites are only added by the dispatcher thread, readers look at the first siteCount of them
+std::array<std::atomic<TaskSite*>, MAX_TASK_SITES> sites{};
+std::atomic<size_t> siteCount{0};
+TaskSite overflowSite{TaskTag{TASK_CATEGORY_OTHER, std::source_location{}}};
+
+// dispatcher thread
+std::unordered_map<TaskSiteKey, TaskSite*, TaskSiteKeyHash> siteIndex;
+
+TaskSite& getSite(const TaskTag& tag)
+{
+	TaskSiteKey key{tag.location.file_name(), tag.location.line(), tag.location.column(), tag.category};
+	auto it = siteIndex.find(key);
+	if (it != siteIndex.end()) {
+		return *it->second;
+	}
+
+	size_t count = siteCount.load(std::memory_order_relaxed);
+	if (count == MAX_TASK_SITES) {
+		return overflowSite;
+	}
+
+	TaskSite* site = new TaskSite(tag);
+	sites[count].store(site, std::memory_order_relaxed);
+	siteCount.store(count + 1, std::memory_order_release);
+	siteIndex.emplace(key, site);
+	return *site;
+}
+
+std::string_view getFileName(const std::source_location& location)
+{
+	std::string_view file = location.file_name();
+	auto pos = file.find_last_of("/\\");
+	return pos == std::string_view::npos ? file : file.substr(pos + 1);
+}
+
+double toMilliseconds(std::chrono::nanoseconds duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+struct SiteSummary
+{
+	const TaskSite* site;
+	uint64_t count;
+	uint64_t expired;
+	std::chrono::nanoseconds waitTotal;
+	std::chrono::nanoseconds runTotal;
+};
+
+void appendRow(std::string& report, std::string_view name, uint64_t count, uint64_t expired,
+               std::chrono::nanoseconds waitTotal, std::chrono::nanoseconds runTotal, const LatencyHistogram* wait,
+               const LatencyHistogram* run)
+{
+	// expired tasks waited as well
+	double waitAverage = count + expired > 0 ? toMilliseconds(waitTotal) / (count + expired) : 0;
+	double runAverage = count > 0 ? toMilliseconds(runTotal) / count : 0;
+	// percentiles and maxima are only kept per site
+	auto format = [](const LatencyHistogram* histogram, auto getter) {
+		return histogram ? fmt::format("{:.3f}", toMilliseconds(getter(*histogram))) : std::string{};
+	};
+	auto p99 = [](const LatencyHistogram& histogram) { return histogram.getPercentile(0.99); };
+	auto max = [](const LatencyHistogram& histogram) { return histogram.getMax(); };
+
+	fmt::format_to(std::back_inserter(report),
+	               "{:<40} {:>10} {:>8} {:>9.3f} {:>9} {:>9} {:>9.3f} {:>9} {:>9} {:>11.1f}\n", name, count, expired,
+	               waitAverage, format(wait, p99), format(wait, max), runAverage, format(run, p99), format(run, max),
+	               toMilliseconds(runTotal));
+}
+
+} // namespace
+
+void LatencyHistogram::add(std::chrono::nanoseconds duration)
+{
+	uint64_t nanoseconds = std::max<int64_t>(duration.count(), 0);
+	size_t bucket = std::min<size_t>(std::bit_width(nanoseconds / 1000), BUCKET_COUNT - 1);
+
+	// single writer, so plain loads and stores are enough to keep readers consistent
+	buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	total.store(total.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+	if (nanoseconds > max.load(std::memory_order_relaxed)) {
+		max.store(nanoseconds, std::memory_order_relaxed);
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	for (auto& bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double fraction) const
+{
+	uint64_t wanted = static_cast<uint64_t>(std::ceil(getCount() * fraction));
+	uint64_t seen = 0;
+	size_t bucket = 0;
+	for (; bucket < BUCKET_COUNT - 1; ++bucket) {
+		seen += buckets[bucket].load(std::memory_order_relaxed);
+		if (seen >= wanted) {
+			break;
+		}
+	}
+	// the top bucket is open ended, and no duration was longer than the maximum
+	return std::min<std::chrono::nanoseconds>(std::chrono::microseconds(uint64_t{1} << bucket), getMax());
+}
+
+bool TaskStatistics::isEnabled() { return recording.load(std::memory_order_relaxed); }
+
+void TaskStatistics::setEnabled(bool enabled)
+{
+	if (enabled && !recording.load(std::memory_order_relaxed)) {
+		recordingSince.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+	}
+	recording.store(enabled, std::memory_order_relaxed);
+}
+
+void TaskStatistics::reset()
+{
+	size_t count = siteCount.load(std::memory_order_acquire);
+	for (size_t i = 0; i < count; ++i) {
+		TaskSite* site = sites[i].load(std::memory_order_relaxed);
+		site->wait.reset();
+		site->run.reset();
+		site->expired.store(0, std::memory_order_relaxed);
+	}
+
+	overflowSite.wait.reset();
+	overflowSite.run.reset();
+	overflowSite.expired.store(0, std::memory_order_relaxed);
+	recordingSince.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void TaskStatistics::recordRun(const TaskTag& tag, std::chrono::nanoseconds wait, std::chrono::nanoseconds run)
+{
+	TaskSite& site = getSite(tag);
+	site.wait.add(wait);
+	site.run.add(run);
+}
+
+void TaskStatistics::recordExpired(const TaskTag& tag, std::chrono::nanoseconds wait)
+{
+	TaskSite& site = getSite(tag);
+	site.wait.add(wait);
+	site.expired.store(site.expired.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+const char* TaskStatistics::getCategoryName(TaskCategory_t category)
+{
+	switch (category) {
+		case TASK_CATEGORY_OTHER:
+			return "other";
+		case TASK_CATEGORY_NETWORK:
+			return "network";
+		case TASK_CATEGORY_LUA:
+			return "lua";
+		case TASK_CATEGORY_DATABASE:
+			return "database";
+		case TASK_CATEGORY_PATHFINDING:
+			return "pathfinding";
+		case TASK_CATEGORY_CREATURE:
+			return "creature";
+		case TASK_CATEGORY_GAME:
+			return "game";
+		case TASK_CATEGORY_BATCH:
+			return "batch";
+		default:
+			return "unknown";
+	}
+}
+
+std::string TaskStatistics::getReport(size_t limit)
+{
+	std::vector<SiteSummary> summaries;
+	size_t count = siteCount.load(std::memory_order_acquire);
+	summaries.reserve(count + 1);
+	for (size_t i = 0; i < count; ++i) {
+		const TaskSite* site = sites[i].load(std::memory_order_relaxed);
+		summaries.push_back({site, site->run.getCount(), site->expired.load(std::memory_order_relaxed),
+		                     site->wait.getTotal(), site->run.getTotal()});
+	}
+	if (overflowSite.wait.getCount() > 0) {
+		summaries.push_back({&overflowSite, overflowSite.run.getCount(),
+		                     overflowSite.expired.load(std::memory_order_relaxed), overflowSite.wait.getTotal(),
+		                     overflowSite.run.getTotal()});
+	}
+
+	std::array<SiteSummary, TASK_CATEGORY_LAST + 1> categories{};
+	uint64_t expiredTotal = 0;
+	for (const SiteSummary& summary : summaries) {
+		SiteSummary& category = categories[summary.site->category];
+		category.count += summary.count;
+		category.expired += summary.expired;
+		category.waitTotal += summary.waitTotal;
+		category.runTotal += summary.runTotal;
+		expiredTotal += summary.expired;
+	}
+
+	auto since = std::chrono::steady_clock::time_point(
+	    std::chrono::steady_clock::duration(recordingSince.load(std::memory_order_relaxed)));
+	std::string report = fmt::format(
+	    "Task statistics for the last {:.1f} s{}, {} expired tasks dropped, times in ms\n",
+	    std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count(),
+	    isEnabled() ? "" : " (recording is off)", expiredTotal);
+
+	fmt::format_to(std::back_inserter(report), "{:<40} {:>10} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>11}\n",
+	               "category / site", "runs", "expired", "wait avg", "wait p99", "wait max", "run avg", "run p99",
+	               "run max", "run total");
+	for (size_t category = 0; category <= TASK_CATEGORY_LAST; ++category) {
+		const SiteSummary& summary = categories[category];
+		if (summary.count > 0 || summary.expired > 0) {
+			appendRow(report, getCategoryName(static_cast<TaskCategory_t>(category)), summary.count, summary.expired,
+			          summary.waitTotal, summary.runTotal, nullptr, nullptr);
+		}
+	}
+	report.push_back('\n');
+
+	std::sort(summaries.begin(), summaries.end(),
+	          [](const SiteSummary& lhs, const SiteSummary& rhs) { return lhs.runTotal > rhs.runTotal; });
+	if (limit != 0 && summaries.size() > limit) {
+		summaries.resize(limit);
+	}
+
+	for (const SiteSummary& summary : summaries) {
+		const TaskSite* site = summary.site;
+		std::string name = site == &overflowSite
+		                       ? std::string{"other sites"}
+		                       : fmt::format("{} {}:{}", getCategoryName(site->category), getFileName(site->location),
+		                                     site->location.line());
+		appendRow(report, name, summary.count, summary.expired, summary.waitTotal, summary.runTotal, &site->wait,
+		          &site->run);
+	}
+	return report;
+}
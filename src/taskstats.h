@@ -0,0 +1,58 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TASKSTATS_H
+#define FS_TASKSTATS_H
+
+#include "tasks.h"
+
+/**
+ * Histogram of durations in power of two microsecond buckets: bucket 0 counts durations below 1 us and bucket i those
+ * from 2^(i-1) up to 2^i us.
+ * There may only be one writer, readers on other threads see consistent counters without locking.
+ */
+class LatencyHistogram
+{
+public:
+	static constexpr size_t BUCKET_COUNT = 32;
+
+	void add(std::chrono::nanoseconds duration);
+	void reset();
+
+	uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+	std::chrono::nanoseconds getTotal() const
+	{
+		return std::chrono::nanoseconds(total.load(std::memory_order_relaxed));
+	}
+	std::chrono::nanoseconds getMax() const { return std::chrono::nanoseconds(max.load(std::memory_order_relaxed)); }
+	// upper bound of the bucket that holds the given fraction of the durations, at most the longest duration
+	std::chrono::nanoseconds getPercentile(double fraction) const;
+
+private:
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> total{0};
+	std::atomic<uint64_t> max{0};
+};
+
+/**
+ * Queue wait and run time of dispatcher tasks per call site.
+ * Tasks are grouped by their TaskTag; the dispatcher thread records them, and reports can be taken from any thread.
+ */
+namespace TaskStatistics {
+
+bool isEnabled();
+void setEnabled(bool enabled);
+void reset();
+
+void recordRun(const TaskTag& tag, std::chrono::nanoseconds wait, std::chrono::nanoseconds run);
+void recordExpired(const TaskTag& tag, std::chrono::nanoseconds wait);
+
+const char* getCategoryName(TaskCategory_t category);
+
+// per category totals followed by the call sites that ran the longest in total, limit 0 lists all of them
+std::string getReport(size_t limit = 0);
+
+} // namespace TaskStatistics
+
+#endif // FS_TASKSTATS_H
@@ -0,0 +1,166 @@
+#define BOOST_TEST_MODULE packetcompression
+
+#include "../otpch.h"
+
+#include "../outputmessage.h"
+#include "../packetcompression.h"
+
+#include <boost/test/unit_test.hpp>
+#include <zlib.h>
+
+namespace {
+
+// the client side, one raw inflate stream for every message of a connection
+class Inflater
+{
+public:
+	Inflater() { BOOST_TEST_REQUIRE(inflateInit2(&stream, -MAX_WBITS) == Z_OK); }
+	~Inflater() { inflateEnd(&stream); }
+
+	std::vector<uint8_t> inflate(const uint8_t* data, size_t length)
+	{
+		std::vector<uint8_t> result(NETWORKMESSAGE_MAXSIZE);
+		stream.next_in = const_cast<uint8_t*>(data);
+		stream.avail_in = length;
+		stream.next_out = result.data();
+		stream.avail_out = result.size();
+		BOOST_TEST_REQUIRE(::inflate(&stream, Z_SYNC_FLUSH) == Z_OK);
+		BOOST_TEST_REQUIRE(stream.avail_in == 0u);
+		result.resize(result.size() - stream.avail_out);
+		return result;
+	}
+
+private:
+	z_stream stream = {};
+};
+
+// a body that looks like a map update, mostly the same bytes over and over with a few changing ones
+std::vector<uint8_t> makeBody(size_t length, uint8_t seed)
+{
+	std::vector<uint8_t> body(length);
+	for (size_t i = 0; i < length; ++i) {
+		body[i] = i % 16 == 0 ? static_cast<uint8_t>(seed + i) : static_cast<uint8_t>(i % 7);
+	}
+	return body;
+}
+
+void setBody(OutputMessage& msg, const std::vector<uint8_t>& body)
+{
+	// addBytes takes at most MAX_STRING_LENGTH bytes at a time
+	for (size_t i = 0; i < body.size(); i += NetworkMessage::MAX_STRING_LENGTH) {
+		const size_t length = std::min(body.size() - i, NetworkMessage::MAX_STRING_LENGTH);
+		msg.addBytes(reinterpret_cast<const char*>(body.data() + i), length);
+	}
+	BOOST_TEST_REQUIRE(msg.getLength() == body.size());
+}
+
+// the inner length header writeMessageLength put in front of the body
+uint16_t getInnerLength(OutputMessage& msg)
+{
+	uint16_t length;
+	std::memcpy(&length, msg.getOutputBuffer(), sizeof(length));
+	return length;
+}
+
+const uint8_t* getBody(OutputMessage& msg) { return msg.getOutputBuffer() + sizeof(uint16_t); }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_packet_compression_round_trip)
+{
+	PacketCompression compression(0);
+	BOOST_TEST_REQUIRE(compression.init(6));
+
+	Inflater inflater;
+	size_t bytesIn = 0;
+	size_t firstLength = 0;
+	for (uint8_t i = 0; i < 20; ++i) {
+		// every other message repeats the one before, which deflates to a back reference
+		const auto body = makeBody(1000, i / 2);
+		bytesIn += body.size();
+
+		OutputMessage msg;
+		setBody(msg, body);
+		const bool compressed = compression.compress(msg);
+		BOOST_TEST_REQUIRE(compressed);
+		msg.writeMessageLength(compressed);
+
+		const uint16_t innerLength = getInnerLength(msg);
+		BOOST_TEST((innerLength & OutputMessage::COMPRESSED_FLAG) != 0);
+
+		const size_t length = innerLength & ~OutputMessage::COMPRESSED_FLAG;
+		BOOST_TEST(length == msg.getLength() - sizeof(uint16_t));
+		BOOST_TEST(length < body.size());
+		BOOST_TEST(inflater.inflate(getBody(msg), length) == body, boost::test_tools::per_element());
+
+		if (i == 0) {
+			firstLength = length;
+		} else if (i % 2 == 1) {
+			BOOST_TEST(length < firstLength / 4);
+		}
+	}
+
+	const CompressionStats stats = compression.getStats();
+	BOOST_TEST(stats.messages == 20u);
+	BOOST_TEST(stats.bytesIn == bytesIn);
+	BOOST_TEST(stats.bytesOut < stats.bytesIn);
+}
+
+BOOST_AUTO_TEST_CASE(test_packet_compression_threshold)
+{
+	PacketCompression compression(128);
+	BOOST_TEST_REQUIRE(compression.init(6));
+
+	Inflater inflater;
+
+	// small bodies go out as they are and stay out of the stream
+	const auto small = makeBody(64, 1);
+	OutputMessage smallMsg;
+	setBody(smallMsg, small);
+	BOOST_TEST(!compression.compress(smallMsg));
+	smallMsg.writeMessageLength();
+	BOOST_TEST(getInnerLength(smallMsg) == small.size());
+	BOOST_TEST(std::equal(small.begin(), small.end(), getBody(smallMsg)));
+
+	const auto large = makeBody(512, 2);
+	OutputMessage largeMsg;
+	setBody(largeMsg, large);
+	BOOST_TEST_REQUIRE(compression.compress(largeMsg));
+	largeMsg.writeMessageLength(true);
+
+	const size_t length = getInnerLength(largeMsg) & ~OutputMessage::COMPRESSED_FLAG;
+	BOOST_TEST(inflater.inflate(getBody(largeMsg), length) == large, boost::test_tools::per_element());
+	BOOST_TEST(compression.getStats().messages == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_packet_compression_fall_back)
+{
+	PacketCompression compression(0);
+	BOOST_TEST_REQUIRE(compression.init(6));
+
+	Inflater inflater;
+
+	// a full body might not fit deflated, so it is sent as it is
+	std::vector<uint8_t> full(NetworkMessage::MAX_PROTOCOL_BODY_LENGTH);
+	std::mt19937 generator(42);
+	std::generate(full.begin(), full.end(), [&generator]() { return static_cast<uint8_t>(generator()); });
+	BOOST_TEST_REQUIRE(full.size() > PacketCompression::MAX_COMPRESSED_LENGTH);
+
+	OutputMessage fullMsg;
+	setBody(fullMsg, full);
+	BOOST_TEST(!compression.compress(fullMsg));
+	fullMsg.writeMessageLength();
+	BOOST_TEST((getInnerLength(fullMsg) & OutputMessage::COMPRESSED_FLAG) == 0);
+	BOOST_TEST(getInnerLength(fullMsg) == full.size());
+	BOOST_TEST(std::equal(full.begin(), full.end(), getBody(fullMsg)));
+
+	// the stream did not see it, so the next message still inflates
+	const auto body = makeBody(1000, 3);
+	OutputMessage msg;
+	setBody(msg, body);
+	BOOST_TEST_REQUIRE(compression.compress(msg));
+	msg.writeMessageLength(true);
+
+	const size_t length = getInnerLength(msg) & ~OutputMessage::COMPRESSED_FLAG;
+	BOOST_TEST(inflater.inflate(getBody(msg), length) == body, boost::test_tools::per_element());
+}
@@ -0,0 +1,232 @@
+#define BOOST_TEST_MODULE tasks
+
+#include "../otpch.h"
+
+#include "../tasks.h"
+
+#include <boost/test/unit_test.hpp>
+#include <numeric>
+
+namespace {
+
+struct Counters
+{
+	int calls = 0;
+	int moves = 0;
+	int destroyed = 0;
+};
+
+// counts what TaskFunc does with it, Padding decides whether it fits inline
+template <size_t Padding>
+struct Tracker
+{
+	explicit Tracker(Counters& counters) : counters(&counters) {}
+	Tracker(Tracker&& other) noexcept : counters(other.counters)
+	{
+		other.counters = nullptr;
+		++counters->moves;
+	}
+	~Tracker()
+	{
+		if (counters) {
+			++counters->destroyed;
+		}
+	}
+
+	void operator()() { ++counters->calls; }
+
+	Counters* counters;
+	std::array<char, Padding> padding = {};
+};
+
+using SmallTracker = Tracker<8>;
+using LargeTracker = Tracker<TaskFunc::INLINE_SIZE>;
+
+static_assert(sizeof(SmallTracker) <= TaskFunc::INLINE_SIZE);
+static_assert(sizeof(LargeTracker) > TaskFunc::INLINE_SIZE);
+
+// the id of the producer in the upper and the sequence number within it in the lower half
+uint64_t makeTaskId(uint32_t producer, uint32_t sequence) { return (static_cast<uint64_t>(producer) << 32) | sequence; }
+
+// pushes tasks that append their id to ran when they are run
+void pushTasks(TaskQueue& queue, std::vector<uint64_t>& ran, uint32_t producer, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i) {
+		queue.push(createTask([&ran, id = makeTaskId(producer, i)]() { ran.push_back(id); }));
+	}
+}
+
+// runs and deletes every task until total have run, returns how often pop came back empty meanwhile
+size_t consumeTasks(TaskQueue& queue, std::vector<uint64_t>& ran, size_t total)
+{
+	size_t emptyPops = 0;
+	while (ran.size() < total) {
+		// only a hint while producers push, empty() may see a task pop does not hand out yet and the other way round
+		if (queue.empty()) {
+			std::this_thread::yield();
+		}
+
+		Task* task = queue.pop();
+		if (!task) {
+			++emptyPops;
+			continue;
+		}
+
+		(*task)();
+		delete task;
+	}
+	return emptyPops;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_task_func_inline)
+{
+	Counters counters;
+	{
+		TaskFunc func(SmallTracker{counters});
+		// constructed from the temporary, then never moved again
+		BOOST_TEST(counters.moves == 1);
+
+		TaskFunc moved(std::move(func));
+		BOOST_TEST(!func);
+		BOOST_TEST(static_cast<bool>(moved));
+		// inline callables move along with the function
+		BOOST_TEST(counters.moves == 2);
+
+		moved();
+		moved();
+		BOOST_TEST(counters.calls == 2);
+		BOOST_TEST(counters.destroyed == 0);
+	}
+	BOOST_TEST(counters.destroyed == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_func_heap)
+{
+	Counters counters;
+	{
+		TaskFunc func(LargeTracker{counters});
+		BOOST_TEST(counters.moves == 1);
+
+		TaskFunc moved(std::move(func));
+		BOOST_TEST(!func);
+		// only the pointer to a heap callable moves
+		BOOST_TEST(counters.moves == 1);
+
+		moved();
+		BOOST_TEST(counters.calls == 1);
+		BOOST_TEST(counters.destroyed == 0);
+	}
+	BOOST_TEST(counters.destroyed == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_func_move_assignment)
+{
+	Counters first;
+	Counters second;
+	{
+		TaskFunc func(SmallTracker{first});
+		TaskFunc other(LargeTracker{second});
+
+		// the callable held before is destroyed right away
+		func = std::move(other);
+		BOOST_TEST(first.destroyed == 1);
+		BOOST_TEST(second.destroyed == 0);
+		BOOST_TEST(!other);
+
+		func();
+		BOOST_TEST(first.calls == 0);
+		BOOST_TEST(second.calls == 1);
+
+		func = TaskFunc{};
+		BOOST_TEST(!func);
+		BOOST_TEST(second.destroyed == 1);
+	}
+	BOOST_TEST(first.destroyed == 1);
+	BOOST_TEST(second.destroyed == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_func_move_only_capture)
+{
+	int result = 0;
+	auto value = std::make_unique<int>(42);
+	TaskFunc func([&result, value = std::move(value)]() { result = *value; });
+
+	TaskFunc moved(std::move(func));
+	moved();
+	BOOST_TEST(result == 42);
+
+	// a large move-only capture goes to the heap
+	std::array<int, 32> values;
+	values.fill(1);
+	auto owned = std::make_unique<std::array<int, 32>>(values);
+	TaskFunc large([&result, owned = std::move(owned)]() { result = std::accumulate(owned->begin(), owned->end(), 0); });
+	TaskFunc movedLarge(std::move(large));
+	movedLarge();
+	BOOST_TEST(result == 32);
+}
+
+BOOST_AUTO_TEST_CASE(test_task_queue_fifo)
+{
+	TaskQueue queue;
+	BOOST_TEST(queue.empty());
+	BOOST_TEST(queue.pop() == nullptr);
+
+	std::vector<uint64_t> ran;
+	pushTasks(queue, ran, 0, 1000);
+	BOOST_TEST(!queue.empty());
+
+	consumeTasks(queue, ran, 1000);
+	for (uint32_t i = 0; i < 1000; ++i) {
+		BOOST_TEST_REQUIRE(ran[i] == makeTaskId(0, i));
+	}
+
+	BOOST_TEST(queue.empty());
+	BOOST_TEST(queue.pop() == nullptr);
+
+	// the stub is back in place, so the queue can be used again
+	pushTasks(queue, ran, 0, 1);
+	BOOST_TEST(!queue.empty());
+	consumeTasks(queue, ran, 1001);
+	BOOST_TEST(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_task_queue_concurrent_producers)
+{
+	constexpr uint32_t producerCount = 8;
+	constexpr uint32_t tasksPerProducer = 50'000;
+	constexpr size_t total = producerCount * tasksPerProducer;
+
+	TaskQueue queue;
+	std::vector<uint64_t> ran;
+	ran.reserve(total);
+
+	// the consumer pops and checks empty() all the time while pushes are half done
+	std::vector<std::thread> producers;
+	for (uint32_t producer = 0; producer < producerCount; ++producer) {
+		producers.emplace_back([&, producer]() { pushTasks(queue, ran, producer, tasksPerProducer); });
+	}
+
+	consumeTasks(queue, ran, total);
+	for (std::thread& thread : producers) {
+		thread.join();
+	}
+
+	BOOST_TEST(queue.empty());
+	BOOST_TEST(queue.pop() == nullptr);
+
+	// every task ran exactly once, and the tasks of each producer in the order it pushed them
+	std::vector<uint32_t> nextSequence(producerCount, 0);
+	for (uint64_t id : ran) {
+		const uint32_t producer = id >> 32;
+		const uint32_t sequence = id & 0xFFFFFFFF;
+		BOOST_TEST_REQUIRE(producer < producerCount);
+		BOOST_TEST_REQUIRE(sequence == nextSequence[producer]);
+		++nextSequence[producer];
+	}
+
+	for (uint32_t producer = 0; producer < producerCount; ++producer) {
+		BOOST_TEST(nextSequence[producer] == tasksPerProducer);
+	}
+}
@@ -41,4 +41,42 @@ BOOST_AUTO_TEST_CASE(test_xtea_decrypt)
 	xtea::decrypt(data.data(), data.size(), xtea::expand_key({0xdeadbeef, 0xdeadbeef, 0xdeadbeef, 0xdeadbeef}));
 
 	BOOST_TEST(data == expected);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(test_xtea_kernels_match_scalar)
+{
+	std::mt19937 rng(0xdeadbeef);
+	std::uniform_int_distribution<uint32_t> words;
+	std::uniform_int_distribution<uint16_t> bytes(0, 0xff);
+
+	// lengths around the 4 and 8 block vectors, so every kernel also goes through its tail
+	std::vector<size_t> lengths = {0, 8, 24, 32, 40, 56, 64, 72, 120, 128, 136, 1024, 24584};
+	for (size_t i = 0; i < 50; ++i) {
+		lengths.push_back(std::uniform_int_distribution<size_t>(0, 3072)(rng) * 8);
+	}
+
+	for (size_t length : lengths) {
+		auto key = xtea::expand_key({words(rng), words(rng), words(rng), words(rng)});
+
+		std::vector<uint8_t> plain(length);
+		std::generate(plain.begin(), plain.end(), [&]() { return static_cast<uint8_t>(bytes(rng)); });
+
+		auto expected = plain;
+		xtea::encrypt(expected.data(), expected.size(), key, xtea::kernel::scalar);
+
+		for (auto impl : {xtea::kernel::sse2, xtea::kernel::avx2, xtea::kernel::neon}) {
+			if (!xtea::is_supported(impl)) {
+				continue;
+			}
+
+			BOOST_TEST_CONTEXT(xtea::kernel_name(impl) << ", " << length << " bytes")
+			{
+				auto data = plain;
+				xtea::encrypt(data.data(), data.size(), key, impl);
+				BOOST_TEST(data == expected);
+
+				xtea::decrypt(data.data(), data.size(), key, impl);
+				BOOST_TEST(data == plain);
+			}
+		}
+	}
+}
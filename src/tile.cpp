@@ -18,9 +18,73 @@
 extern Game g_game;
 extern MoveEvents* g_moveEvents;
 
+namespace {
+
+// the cached tile descriptions from the most to the least recently used one
+TileItemsDescriptions* mostRecentDescriptions = nullptr;
+TileItemsDescriptions* leastRecentDescriptions = nullptr;
+size_t cachedDescriptions = 0;
+
+void linkDescriptions(TileItemsDescriptions& descriptions)
+{
+	descriptions.prev = nullptr;
+	descriptions.next = mostRecentDescriptions;
+	if (mostRecentDescriptions) {
+		mostRecentDescriptions->prev = &descriptions;
+	} else {
+		leastRecentDescriptions = &descriptions;
+	}
+	mostRecentDescriptions = &descriptions;
+}
+
+void unlinkDescriptions(TileItemsDescriptions& descriptions)
+{
+	if (descriptions.prev) {
+		descriptions.prev->next = descriptions.next;
+	} else {
+		mostRecentDescriptions = descriptions.next;
+	}
+
+	if (descriptions.next) {
+		descriptions.next->prev = descriptions.prev;
+	} else {
+		leastRecentDescriptions = descriptions.prev;
+	}
+}
+
+} // namespace
+
 StaticTile real_nullptr_tile(0xFFFF, 0xFFFF, 0xFF);
 Tile& Tile::nullptr_tile = real_nullptr_tile;
 
+TileItemsDescriptions::TileItemsDescriptions(const Tile* tile) : tile(tile)
+{
+	linkDescriptions(*this);
+	++cachedDescriptions;
+}
+
+TileItemsDescriptions::~TileItemsDescriptions()
+{
+	unlinkDescriptions(*this);
+	--cachedDescriptions;
+}
+
+TileItemsDescription& Tile::getItemsDescription(bool otcv8) const
+{
+	if (itemsDescriptions) {
+		if (itemsDescriptions.get() != mostRecentDescriptions) {
+			unlinkDescriptions(*itemsDescriptions);
+			linkDescriptions(*itemsDescriptions);
+		}
+	} else {
+		if (cachedDescriptions == TileItemsDescriptions::MAX_CACHED_TILES) {
+			leastRecentDescriptions->tile->itemsDescriptions.reset();
+		}
+		itemsDescriptions = std::make_unique<TileItemsDescriptions>(this);
+	}
+	return itemsDescriptions->descriptions[otcv8];
+}
+
 bool Tile::hasProperty(ITEMPROPERTY prop) const
 {
 	if (ground && ground->hasProperty(prop)) {
@@ -347,6 +411,7 @@ Thing* Tile::getTopVisibleThing(const Creature* creature)
 
 void Tile::onAddTileItem(Item* item)
 {
+	++itemsVersion;
 	setTileFlags(item);
 
 	const Position& cylinderMapPos = getPosition();
@@ -376,6 +441,8 @@ void Tile::onAddTileItem(Item* item)
 
 void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newItem, const ItemType& newType)
 {
+	++itemsVersion;
+
 	const Position& cylinderMapPos = getPosition();
 
 	SpectatorVec spectators;
@@ -396,6 +463,7 @@ void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newIte
 
 void Tile::onRemoveTileItem(const SpectatorVec& spectators, const std::vector<int32_t>& oldStackPosVector, Item* item)
 {
+	++itemsVersion;
 	resetTileFlags(item);
 
 	const Position& cylinderMapPos = getPosition();
@@ -805,14 +873,12 @@ void Tile::addThing(int32_t, Thing* thing)
 {
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.invalidateSpectators(tilePos, creature->getPlayer() != nullptr);
 
 		creature->setParent(this);
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
+		g_game.map.updateTileBitmaps(*this);
 	} else {
 		Item* item = thing->getItem();
 		if (item == nullptr) {
@@ -1016,12 +1082,10 @@ void Tile::removeThing(Thing* thing, uint32_t count)
 		if (creatures) {
 			auto it = std::find(creatures->begin(), creatures->end(), thing);
 			if (it != creatures->end()) {
-				g_game.map.clearSpectatorCache();
-				if (creature->getPlayer()) {
-					g_game.map.clearPlayersSpectatorCache();
-				}
+				g_game.map.invalidateSpectators(tilePos, creature->getPlayer() != nullptr);
 
 				creatures->erase(it);
+				g_game.map.updateTileBitmaps(*this);
 			}
 		}
 		return;
@@ -1112,7 +1176,7 @@ bool Tile::hasCreature(Creature* creature) const
 
 void Tile::removeCreature(Creature* creature)
 {
-	g_game.map.getQTNode(tilePos.x, tilePos.y)->removeCreature(creature);
+	g_game.map.getMapSector(tilePos.x, tilePos.y)->removeCreature(creature);
 	removeThing(creature, 0);
 }
 
@@ -1383,19 +1447,19 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.invalidateSpectators(tilePos, creature->getPlayer() != nullptr);
 
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
+		g_game.map.updateTileBitmaps(*this);
 	} else {
 		Item* item = thing->getItem();
 		if (item == nullptr) {
 			return;
 		}
 
+		++itemsVersion;
+
 		const ItemType& itemType = Item::items[item->getID()];
 		if (itemType.isGroundTile()) {
 			if (ground == nullptr) {
@@ -1434,8 +1498,8 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 
 void Tile::setTileFlags(const Item* item)
 {
+	const ItemType& it = Item::items[item->getID()];
 	if (!hasFlag(TILESTATE_FLOORCHANGE)) {
-		const ItemType& it = Item::items[item->getID()];
 		if (it.floorChange != 0) {
 			setFlag(it.floorChange);
 		}
@@ -1489,6 +1553,17 @@ void Tile::setTileFlags(const Item* item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		setFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
+		setFlag(TILESTATE_BLOCKPROJECTILE);
+	}
+
+	if (it.isGroundTile() || it.floorChange != 0 || item->getTeleport() ||
+	    item->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID)) {
+		g_game.map.invalidatePathGraph(tilePos);
+	}
+
+	g_game.map.updateTileBitmaps(*this);
 }
 
 void Tile::resetTileFlags(const Item* item)
@@ -1551,6 +1626,17 @@ void Tile::resetTileFlags(const Item* item)
 	if (item->hasProperty(CONST_PROP_SUPPORTHANGABLE)) {
 		resetFlag(TILESTATE_SUPPORTS_HANGABLE);
 	}
+
+	if (item->hasProperty(CONST_PROP_BLOCKPROJECTILE) && !hasProperty(item, CONST_PROP_BLOCKPROJECTILE)) {
+		resetFlag(TILESTATE_BLOCKPROJECTILE);
+	}
+
+	if (it.isGroundTile() || it.floorChange != 0 || item->getTeleport() ||
+	    item->hasProperty(CONST_PROP_IMMOVABLEBLOCKSOLID)) {
+		g_game.map.invalidatePathGraph(tilePos);
+	}
+
+	g_game.map.updateTileBitmaps(*this);
 }
 
 bool Tile::isMoveableBlocking() const { return !ground || hasFlag(TILESTATE_BLOCKSOLID); }
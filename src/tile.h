@@ -14,7 +14,7 @@ class Teleport;
 class TrashHolder;
 class Mailbox;
 class MagicField;
-class QTreeLeafNode;
+class MapSector;
 class BedItem;
 
 using CreatureVector = std::vector<Creature*>;
@@ -22,6 +22,41 @@ using ItemVector = std::vector<Item*>;
 
 inline constexpr int32_t MAX_STACKPOS_THINGS = 10;
 
+// Ground and items of a tile as the client gets them, built by ProtocolGame::GetTileDescription and reused until the
+// items of the tile change. Only the things a client can see are encoded, creatures are added at send time.
+struct TileItemsDescription
+{
+	std::vector<uint8_t> bytes;
+	// where each thing ends in bytes, the ground and top items come first and are followed by the down items
+	std::array<uint16_t, MAX_STACKPOS_THINGS> ends;
+	uint8_t thingCount = 0;
+	uint8_t topCount = 0;
+	// items version of the tile the bytes were built for, 0 if they were never built
+	uint32_t version = 0;
+	// Items::getGeneration the bytes were built with, a reload of the item types invalidates every tile
+	uint32_t itemsGeneration = 0;
+};
+
+// The cached descriptions of one tile in both item encodings. All of them are linked in the order they were last used,
+// and only the MAX_CACHED_TILES most recently used tiles keep theirs. Dispatcher thread only.
+struct TileItemsDescriptions
+{
+	// a cached tile takes up about 150 bytes plus the encoded items, which keeps the cache well below 32 MB
+	static constexpr size_t MAX_CACHED_TILES = 1 << 16;
+
+	explicit TileItemsDescriptions(const Tile* tile);
+	~TileItemsDescriptions();
+
+	// non-copyable
+	TileItemsDescriptions(const TileItemsDescriptions&) = delete;
+	TileItemsDescriptions& operator=(const TileItemsDescriptions&) = delete;
+
+	std::array<TileItemsDescription, 2> descriptions;
+	const Tile* tile;
+	TileItemsDescriptions* prev = nullptr;
+	TileItemsDescriptions* next = nullptr;
+};
+
 enum tileflags_t : uint32_t
 {
 	TILESTATE_NONE = 0,
@@ -50,6 +85,7 @@ enum tileflags_t : uint32_t
 	TILESTATE_IMMOVABLENOFIELDBLOCKPATH = 1 << 21,
 	TILESTATE_NOFIELDBLOCKPATH = 1 << 22,
 	TILESTATE_SUPPORTS_HANGABLE = 1 << 23,
+	TILESTATE_BLOCKPROJECTILE = 1 << 24,
 
 	TILESTATE_FLOORCHANGE = TILESTATE_FLOORCHANGE_DOWN | TILESTATE_FLOORCHANGE_NORTH | TILESTATE_FLOORCHANGE_SOUTH |
 	                        TILESTATE_FLOORCHANGE_EAST | TILESTATE_FLOORCHANGE_WEST | TILESTATE_FLOORCHANGE_SOUTH_ALT |
@@ -235,7 +271,17 @@ public:
 	Item* getUseItem(int32_t index) const;
 
 	Item* getGround() const { return ground; }
-	void setGround(Item* item) { ground = item; }
+	void setGround(Item* item)
+	{
+		ground = item;
+		++itemsVersion;
+	}
+
+	// changes whenever an item of the tile is added, removed or updated
+	uint32_t getItemsVersion() const { return itemsVersion; }
+	// the cached description for one of the two item encodings, allocated when it is needed and dropped again once
+	// the tile is among the least recently used ones
+	TileItemsDescription& getItemsDescription(bool otcv8) const;
 
 private:
 	void onAddTileItem(Item* item);
@@ -249,6 +295,8 @@ private:
 	Item* ground = nullptr;
 	Position tilePos;
 	uint32_t flags = 0;
+	uint32_t itemsVersion = 1;
+	mutable std::unique_ptr<TileItemsDescriptions> itemsDescriptions;
 };
 
 // Used for walkable tiles, where there is high likeliness of
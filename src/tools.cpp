@@ -261,14 +261,14 @@ IntegerVector vectorAtoi(const std::vector<std::string_view>& stringVector)
 
 std::mt19937& getRandomGenerator()
 {
-	static std::random_device rd;
-	static std::mt19937 generator(rd());
+	// one generator per thread, map loading creates items with random durations on worker threads
+	thread_local std::mt19937 generator(std::random_device{}());
 	return generator;
 }
 
 int32_t uniform_random(int32_t minNumber, int32_t maxNumber)
 {
-	static std::uniform_int_distribution<int32_t> uniformRand;
+	thread_local std::uniform_int_distribution<int32_t> uniformRand;
 	if (minNumber == maxNumber) {
 		return minNumber;
 	} else if (minNumber > maxNumber) {
@@ -279,7 +279,7 @@ int32_t uniform_random(int32_t minNumber, int32_t maxNumber)
 
 int32_t normal_random(int32_t minNumber, int32_t maxNumber)
 {
-	static std::normal_distribution<float> normalRand(0.5f, 0.25f);
+	thread_local std::normal_distribution<float> normalRand(0.5f, 0.25f);
 
 	float v;
 	do {
@@ -292,7 +292,7 @@ int32_t normal_random(int32_t minNumber, int32_t maxNumber)
 
 bool boolean_random(double probability /* = 0.5*/)
 {
-	static std::bernoulli_distribution booleanRand;
+	thread_local std::bernoulli_distribution booleanRand;
 	return booleanRand(getRandomGenerator(), std::bernoulli_distribution::param_type(probability));
 }
 
@@ -0,0 +1,192 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "workerpool.h"
+
+thread_local WorkerPool::Worker* WorkerPool::currentWorker = nullptr;
+
+namespace {
+
+struct ParallelFor
+{
+	ParallelFor(const std::function<void(size_t)>& job, size_t count) : job{job}, count{count} {}
+
+	// only called while the caller of parallelFor waits, the counters outlive it for workers that start late
+	const std::function<void(size_t)>& job;
+	const size_t count;
+	std::atomic<size_t> nextIndex{0};
+	std::atomic<size_t> doneCount{0};
+
+	std::mutex doneLock;
+	std::condition_variable doneSignal;
+};
+
+void runParallelFor(ParallelFor& state)
+{
+	size_t done = 0;
+	for (size_t i; (i = state.nextIndex.fetch_add(1, std::memory_order_relaxed)) < state.count;) {
+		state.job(i);
+		++done;
+	}
+
+	if (done != 0 && state.doneCount.fetch_add(done, std::memory_order_acq_rel) + done == state.count) {
+		std::lock_guard<std::mutex> lockGuard(state.doneLock);
+		state.doneSignal.notify_one();
+	}
+}
+
+} // namespace
+
+void WorkerPool::start(size_t threadCount)
+{
+	startTime = std::chrono::steady_clock::now();
+
+	// every queue has to exist before the first worker looks for jobs to steal
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		workers.push_back(std::make_unique<Worker>());
+		workers.back()->index = i;
+	}
+
+	for (auto& worker : workers) {
+		worker->thread = std::thread(&WorkerPool::threadMain, this, std::ref(*worker));
+	}
+}
+
+void WorkerPool::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(sleepLock);
+		stopping = true;
+	}
+	sleepSignal.notify_all();
+
+	for (auto& worker : workers) {
+		worker->thread.join();
+	}
+	workers.clear();
+}
+
+void WorkerPool::addJob(TaskFunc&& job)
+{
+	if (workers.empty()) {
+		job();
+		return;
+	}
+
+	Worker* worker = currentWorker;
+	if (!worker) {
+		worker = workers[nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size()].get();
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(worker->jobLock);
+		worker->jobs.push_back(std::move(job));
+		queuedJobs.fetch_add(1, std::memory_order_release);
+	}
+
+	// a worker checks queuedJobs under sleepLock before it sleeps, so it either sees the job or gets woken up
+	{
+		std::lock_guard<std::mutex> lockGuard(sleepLock);
+	}
+	sleepSignal.notify_one();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+	if (workers.empty() || count <= 1) {
+		for (size_t i = 0; i < count; ++i) {
+			job(i);
+		}
+		return;
+	}
+
+	auto state = std::make_shared<ParallelFor>(job, count);
+	for (size_t i = 0, helpers = std::min(workers.size(), count - 1); i < helpers; ++i) {
+		addJob([state]() { runParallelFor(*state); });
+	}
+
+	runParallelFor(*state);
+
+	std::unique_lock<std::mutex> doneLock(state->doneLock);
+	state->doneSignal.wait(doneLock,
+	                       [&]() { return state->doneCount.load(std::memory_order_acquire) == state->count; });
+}
+
+std::vector<WorkerStats> WorkerPool::getStats() const
+{
+	std::vector<WorkerStats> stats;
+	stats.reserve(workers.size());
+	for (const auto& worker : workers) {
+		WorkerStats& workerStats = stats.emplace_back();
+		workerStats.jobs = worker->jobCount.load(std::memory_order_relaxed);
+		workerStats.steals = worker->stealCount.load(std::memory_order_relaxed);
+		workerStats.busyTime = std::chrono::nanoseconds(worker->busyTime.load(std::memory_order_relaxed));
+	}
+	return stats;
+}
+
+std::chrono::nanoseconds WorkerPool::getUptime() const
+{
+	if (workers.empty()) {
+		return std::chrono::nanoseconds::zero();
+	}
+	return std::chrono::steady_clock::now() - startTime;
+}
+
+void WorkerPool::threadMain(Worker& worker)
+{
+	currentWorker = &worker;
+
+	TaskFunc job;
+	while (true) {
+		if (takeJob(worker, job)) {
+			auto start = std::chrono::steady_clock::now();
+			job();
+			job = TaskFunc{};
+			auto duration = std::chrono::steady_clock::now() - start;
+
+			worker.jobCount.fetch_add(1, std::memory_order_relaxed);
+			worker.busyTime.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+			                          std::memory_order_relaxed);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> sleepUniqueLock(sleepLock);
+		sleepSignal.wait(sleepUniqueLock,
+		                 [this]() { return stopping || queuedJobs.load(std::memory_order_acquire) != 0; });
+		if (stopping && queuedJobs.load(std::memory_order_acquire) == 0) {
+			break;
+		}
+	}
+
+	currentWorker = nullptr;
+}
+
+bool WorkerPool::takeJob(Worker& worker, TaskFunc& job)
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(worker.jobLock);
+		if (!worker.jobs.empty()) {
+			job = std::move(worker.jobs.back());
+			worker.jobs.pop_back();
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < workers.size(); ++i) {
+		Worker& victim = *workers[(worker.index + i) % workers.size()];
+		std::lock_guard<std::mutex> lockGuard(victim.jobLock);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			worker.stealCount.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,117 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_WORKERPOOL_H
+#define FS_WORKERPOOL_H
+
+#include "tasks.h"
+
+#include <condition_variable>
+#include <future>
+
+struct WorkerStats
+{
+	uint64_t jobs = 0;
+	// jobs taken from the queue of another worker
+	uint64_t steals = 0;
+	std::chrono::nanoseconds busyTime{0};
+};
+
+/**
+ * Threads for work that does not have to run on the dispatcher.
+ * Every worker has its own job queue; it runs the newest job of its own queue first and takes the oldest one of
+ * another worker when it runs out. Jobs added from a worker go to its own queue, all others are spread over the
+ * workers in turn.
+ * Jobs may only read game state while the dispatcher waits for them, as parallelFor does; everything else has to hand
+ * its result back to the dispatcher, e.g. through the callback of submit.
+ * Check everything a job calls before moving work onto the pool. The random numbers of tools.cpp are per thread, but
+ * creating items is only safe with Item::deferRegistration set, otherwise they register with g_game.
+ */
+class WorkerPool
+{
+public:
+	WorkerPool() = default;
+
+	// non-copyable
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// without any threads, jobs run right away on the thread that adds them
+	void start(size_t threadCount);
+	// runs the jobs that are left and stops the workers
+	void shutdown();
+
+	size_t getThreadCount() const { return workers.size(); }
+	// true on the threads of the pool, not on a thread that takes part in parallelFor
+	static bool isWorkerThread() { return currentWorker != nullptr; }
+
+	void addJob(TaskFunc&& job);
+
+	// runs work on a worker, the future holds its result or the exception it threw
+	template <typename F>
+	auto submit(F&& work) -> std::future<std::invoke_result_t<std::decay_t<F>&>>
+	{
+		std::packaged_task<std::invoke_result_t<std::decay_t<F>&>()> task(std::forward<F>(work));
+		auto future = task.get_future();
+		addJob(std::move(task));
+		return future;
+	}
+
+	// runs work on a worker and then callback on the dispatcher, with the result of work unless it returns void
+	template <typename F, typename C>
+	void submit(F&& work, C&& callback, const TaskTag& tag = {})
+	{
+		addJob([work = std::forward<F>(work), callback = std::forward<C>(callback), tag]() mutable {
+			if constexpr (std::is_void_v<std::invoke_result_t<std::decay_t<F>&>>) {
+				work();
+				g_dispatcher.addTask(std::move(callback), tag);
+			} else {
+				g_dispatcher.addTask(
+				    [result = work(), callback = std::move(callback)]() mutable { callback(std::move(result)); }, tag);
+			}
+		});
+	}
+
+	/**
+	 * Calls job for every index in [0, count) on the workers and the calling thread.
+	 * Returns once all calls are done.
+	 */
+	void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	std::vector<WorkerStats> getStats() const;
+	// time since start, the busy time of a worker compares to it
+	std::chrono::nanoseconds getUptime() const;
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		std::mutex jobLock;
+		std::deque<TaskFunc> jobs;
+		size_t index = 0;
+
+		std::atomic<uint64_t> jobCount{0};
+		std::atomic<uint64_t> stealCount{0};
+		std::atomic<int64_t> busyTime{0};
+	};
+
+	void threadMain(Worker& worker);
+	bool takeJob(Worker& worker, TaskFunc& job);
+
+	static thread_local Worker* currentWorker;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<size_t> nextWorker{0};
+	// jobs in any of the queues, workers only sleep while there are none
+	std::atomic<size_t> queuedJobs{0};
+
+	std::mutex sleepLock;
+	std::condition_variable sleepSignal;
+	bool stopping = false;
+
+	std::chrono::steady_clock::time_point startTime;
+};
+
+extern WorkerPool g_workerPool;
+
+#endif // FS_WORKERPOOL_H
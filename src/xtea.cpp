@@ -7,23 +7,27 @@
 
 #include <cstring>
 
-namespace xtea {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define XTEA_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define XTEA_TARGET_SSE2
+#define XTEA_TARGET_AVX2
+#else
+#define XTEA_TARGET_SSE2 __attribute__((target("sse2")))
+#define XTEA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define XTEA_NEON
+#include <arm_neon.h>
+#endif
 
-round_keys expand_key(const key& k)
-{
-	constexpr uint32_t delta = 0x9E3779B9;
-	round_keys expanded;
-
-	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
-	     i += 2, sum = next_sum, next_sum += delta) {
-		expanded[i] = sum + k[sum & 3];
-		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
-	}
+namespace xtea {
 
-	return expanded;
-}
+namespace {
 
-void encrypt(uint8_t* data, size_t length, const round_keys& k)
+void encrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = 0u; i < k.size(); i += 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -40,7 +44,7 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
-void decrypt(uint8_t* data, size_t length, const round_keys& k)
+void decrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = k.size(); i > 0; i -= 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -57,4 +61,296 @@ void decrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
+// The vector kernels split the blocks into a vector of left and one of right halves, run all rounds on them while
+// they stay in registers and leave the blocks that do not fill a whole vector to a narrower kernel.
+
+#ifdef XTEA_X86
+XTEA_TARGET_SSE2 __m128i mix_sse2(__m128i v)
+{
+	return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v);
+}
+
+XTEA_TARGET_SSE2 __m128i key_sse2(uint32_t k) { return _mm_set1_epi32(static_cast<int32_t>(k)); }
+
+XTEA_TARGET_SSE2 void load_sse2(const uint8_t* it, __m128i& left, __m128i& right)
+{
+	__m128 low = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)));
+	__m128 high = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 16)));
+	left = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+	right = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+XTEA_TARGET_SSE2 void store_sse2(uint8_t* it, __m128i left, __m128i right)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(it), _mm_unpacklo_epi32(left, right));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(it + 16), _mm_unpackhi_epi32(left, right));
+}
+
+XTEA_TARGET_SSE2 void encrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (auto it = data, last = data + vectorLength; it < last; it += 32) {
+		__m128i left, right;
+		load_sse2(it, left, right);
+		for (auto i = 0u; i < k.size(); i += 2) {
+			left = _mm_add_epi32(left, _mm_xor_si128(mix_sse2(right), key_sse2(k[i])));
+			right = _mm_add_epi32(right, _mm_xor_si128(mix_sse2(left), key_sse2(k[i + 1])));
+		}
+		store_sse2(it, left, right);
+	}
+
+	encrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+
+XTEA_TARGET_SSE2 void decrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (auto it = data, last = data + vectorLength; it < last; it += 32) {
+		__m128i left, right;
+		load_sse2(it, left, right);
+		for (auto i = k.size(); i > 0; i -= 2) {
+			right = _mm_sub_epi32(right, _mm_xor_si128(mix_sse2(left), key_sse2(k[i - 1])));
+			left = _mm_sub_epi32(left, _mm_xor_si128(mix_sse2(right), key_sse2(k[i - 2])));
+		}
+		store_sse2(it, left, right);
+	}
+
+	decrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+
+XTEA_TARGET_AVX2 __m256i mix_avx2(__m256i v)
+{
+	return _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v);
+}
+
+XTEA_TARGET_AVX2 __m256i key_avx2(uint32_t k) { return _mm256_set1_epi32(static_cast<int32_t>(k)); }
+
+// the halves end up in a different order than the blocks, store_avx2 puts them back
+XTEA_TARGET_AVX2 void load_avx2(const uint8_t* it, __m256i& left, __m256i& right)
+{
+	__m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)));
+	__m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + 32)));
+	left = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+	right = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+XTEA_TARGET_AVX2 void store_avx2(uint8_t* it, __m256i left, __m256i right)
+{
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(it), _mm256_unpacklo_epi32(left, right));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(it + 32), _mm256_unpackhi_epi32(left, right));
+}
+
+XTEA_TARGET_AVX2 void encrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{63};
+	for (auto it = data, last = data + vectorLength; it < last; it += 64) {
+		__m256i left, right;
+		load_avx2(it, left, right);
+		for (auto i = 0u; i < k.size(); i += 2) {
+			left = _mm256_add_epi32(left, _mm256_xor_si256(mix_avx2(right), key_avx2(k[i])));
+			right = _mm256_add_epi32(right, _mm256_xor_si256(mix_avx2(left), key_avx2(k[i + 1])));
+		}
+		store_avx2(it, left, right);
+	}
+
+	encrypt_sse2(data + vectorLength, length - vectorLength, k);
+}
+
+XTEA_TARGET_AVX2 void decrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{63};
+	for (auto it = data, last = data + vectorLength; it < last; it += 64) {
+		__m256i left, right;
+		load_avx2(it, left, right);
+		for (auto i = k.size(); i > 0; i -= 2) {
+			right = _mm256_sub_epi32(right, _mm256_xor_si256(mix_avx2(left), key_avx2(k[i - 1])));
+			left = _mm256_sub_epi32(left, _mm256_xor_si256(mix_avx2(right), key_avx2(k[i - 2])));
+		}
+		store_avx2(it, left, right);
+	}
+
+	decrypt_sse2(data + vectorLength, length - vectorLength, k);
+}
+
+bool cpu_supports(kernel impl)
+{
+#ifdef _MSC_VER
+	std::array<int, 4> info;
+	__cpuid(info.data(), 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info.data(), 1);
+	if (impl == kernel::sse2) {
+		return (info[3] & (1 << 26)) != 0;
+	}
+
+	// the OS has to save the ymm registers as well
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave || (_xgetbv(0) & 6) != 6 || maxLeaf < 7) {
+		return false;
+	}
+
+	__cpuidex(info.data(), 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	if (impl == kernel::sse2) {
+		return __builtin_cpu_supports("sse2");
+	}
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef XTEA_NEON
+uint32x4_t mix_neon(uint32x4_t v) { return vaddq_u32(veorq_u32(vshlq_n_u32(v, 4), vshrq_n_u32(v, 5)), v); }
+
+void encrypt_neon(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (auto it = data, last = data + vectorLength; it < last; it += 32) {
+		// the structure load splits the blocks into their halves on its own
+		uint32x4x2_t blocks = vld2q_u32(reinterpret_cast<const uint32_t*>(it));
+		for (auto i = 0u; i < k.size(); i += 2) {
+			blocks.val[0] = vaddq_u32(blocks.val[0], veorq_u32(mix_neon(blocks.val[1]), vdupq_n_u32(k[i])));
+			blocks.val[1] = vaddq_u32(blocks.val[1], veorq_u32(mix_neon(blocks.val[0]), vdupq_n_u32(k[i + 1])));
+		}
+		vst2q_u32(reinterpret_cast<uint32_t*>(it), blocks);
+	}
+
+	encrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+
+void decrypt_neon(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (auto it = data, last = data + vectorLength; it < last; it += 32) {
+		uint32x4x2_t blocks = vld2q_u32(reinterpret_cast<const uint32_t*>(it));
+		for (auto i = k.size(); i > 0; i -= 2) {
+			blocks.val[1] = vsubq_u32(blocks.val[1], veorq_u32(mix_neon(blocks.val[0]), vdupq_n_u32(k[i - 1])));
+			blocks.val[0] = vsubq_u32(blocks.val[0], veorq_u32(mix_neon(blocks.val[1]), vdupq_n_u32(k[i - 2])));
+		}
+		vst2q_u32(reinterpret_cast<uint32_t*>(it), blocks);
+	}
+
+	decrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+#endif
+
+using crypt_func = void (*)(uint8_t*, size_t, const round_keys&);
+
+crypt_func get_encrypt(kernel impl)
+{
+	switch (impl) {
+#ifdef XTEA_X86
+		case kernel::sse2:
+			return encrypt_sse2;
+		case kernel::avx2:
+			return encrypt_avx2;
+#endif
+#ifdef XTEA_NEON
+		case kernel::neon:
+			return encrypt_neon;
+#endif
+		default:
+			return encrypt_scalar;
+	}
+}
+
+crypt_func get_decrypt(kernel impl)
+{
+	switch (impl) {
+#ifdef XTEA_X86
+		case kernel::sse2:
+			return decrypt_sse2;
+		case kernel::avx2:
+			return decrypt_avx2;
+#endif
+#ifdef XTEA_NEON
+		case kernel::neon:
+			return decrypt_neon;
+#endif
+		default:
+			return decrypt_scalar;
+	}
+}
+
+} // namespace
+
+kernel best_kernel()
+{
+	static const kernel best = []() {
+		for (kernel impl : {kernel::avx2, kernel::sse2, kernel::neon}) {
+			if (is_supported(impl)) {
+				return impl;
+			}
+		}
+		return kernel::scalar;
+	}();
+	return best;
+}
+
+bool is_supported(kernel impl)
+{
+	switch (impl) {
+		case kernel::scalar:
+			return true;
+#ifdef XTEA_X86
+		case kernel::sse2:
+		case kernel::avx2:
+			return cpu_supports(impl);
+#endif
+#ifdef XTEA_NEON
+		case kernel::neon:
+			// part of every ARMv8 CPU
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+std::string_view kernel_name(kernel impl)
+{
+	switch (impl) {
+		case kernel::sse2:
+			return "SSE2";
+		case kernel::avx2:
+			return "AVX2";
+		case kernel::neon:
+			return "NEON";
+		default:
+			return "scalar";
+	}
+}
+
+round_keys expand_key(const key& k)
+{
+	constexpr uint32_t delta = 0x9E3779B9;
+	round_keys expanded;
+
+	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
+	     i += 2, sum = next_sum, next_sum += delta) {
+		expanded[i] = sum + k[sum & 3];
+		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
+	}
+
+	return expanded;
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys& k)
+{
+	static const crypt_func func = get_encrypt(best_kernel());
+	func(data, length, k);
+}
+
+void decrypt(uint8_t* data, size_t length, const round_keys& k)
+{
+	static const crypt_func func = get_decrypt(best_kernel());
+	func(data, length, k);
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys& k, kernel impl) { get_encrypt(impl)(data, length, k); }
+
+void decrypt(uint8_t* data, size_t length, const round_keys& k, kernel impl) { get_decrypt(impl)(data, length, k); }
+
 } // namespace xtea
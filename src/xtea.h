@@ -9,9 +9,27 @@ namespace xtea {
 using key = std::array<uint32_t, 4>;
 using round_keys = std::array<uint32_t, 64>;
 
+// the scalar kernel is the reference, the vector kernels encrypt several blocks at once and give the same output
+enum class kernel : uint8_t
+{
+	scalar,
+	sse2,
+	avx2,
+	neon,
+};
+
+// fastest kernel the CPU supports, detected once
+kernel best_kernel();
+bool is_supported(kernel impl);
+std::string_view kernel_name(kernel impl);
+
 round_keys expand_key(const key& k);
+// length must be a multiple of 8, both use best_kernel
 void encrypt(uint8_t* data, size_t length, const round_keys& k);
 void decrypt(uint8_t* data, size_t length, const round_keys& k);
+// impl has to be supported
+void encrypt(uint8_t* data, size_t length, const round_keys& k, kernel impl);
+void decrypt(uint8_t* data, size_t length, const round_keys& k, kernel impl);
 
 } // namespace xtea
 